@@ -0,0 +1,125 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#pragma once
+
+#include "../headers/tinyxml2.h"
+
+namespace xmlEditor
+{
+    // Recorrido de los elementos de un subárbol sin recursión y sin reservar memoria: solo sigue
+    // los enlaces de tinyxml2 al primer hijo, al siguiente hermano y al padre, así que no depende
+    // de la profundidad del árbol. En preorden cada elemento sale antes que sus hijos y
+    // SkipChildren evita entrar en los del actual; en postorden sale después de ellos.
+    // No lee los capítulos diferidos: recorre lo que ya está en memoria.
+    //
+    //   for (ElementCursor cursor(root); cursor; cursor.Next())
+    //   {
+    //       cursor.Current() ...
+    //   }
+    template <typename Element>
+    class BasicElementCursor {
+
+    public:
+        enum class Order
+        {
+            PreOrder,
+            PostOrder
+        };
+
+        // Empieza en top (preorden) o en su primera hoja (postorden); top es siempre el último en postorden
+        explicit BasicElementCursor(Element* top, Order order = Order::PreOrder) : top(top), current(top), order(order)
+        {
+            if (order == Order::PostOrder)
+            {
+                DescendToFirstLeaf();
+            }
+        }
+
+        Element* Current() const { return current; }
+
+        // Profundidad del elemento actual respecto a top (0)
+        int Depth() const { return depth; }
+
+        // Indica si quedan elementos
+        explicit operator bool() const { return current != nullptr; }
+
+        // En preorden, el siguiente Next pasa al hermano del actual sin entrar en sus hijos
+        void SkipChildren() { skipChildren = true; }
+
+        // Pasa al siguiente elemento; al acabar Current devuelve nullptr
+        void Next()
+        {
+            if (current == nullptr)
+            {
+                return;
+            }
+            if (order == Order::PreOrder)
+            {
+                NextPreOrder();
+            }
+            else
+            {
+                NextPostOrder();
+            }
+            skipChildren = false;
+        }
+
+    private:
+        void NextPreOrder()
+        {
+            if (!skipChildren)
+            {
+                if (Element* child = current->FirstChildElement())
+                {
+                    current = child;
+                    depth++;
+                    return;
+                }
+            }
+
+            // Se sube hasta un padre con hermano siguiente, sin salir de top
+            while (current != top && current->NextSiblingElement() == nullptr)
+            {
+                current = current->Parent()->ToElement();
+                depth--;
+            }
+            current = current == top ? nullptr : current->NextSiblingElement();
+        }
+
+        void NextPostOrder()
+        {
+            if (current == top)
+            {
+                current = nullptr;
+                return;
+            }
+            if (Element* sibling = current->NextSiblingElement())
+            {
+                current = sibling;
+                DescendToFirstLeaf();
+                return;
+            }
+            current = current->Parent()->ToElement();
+            depth--;
+        }
+
+        void DescendToFirstLeaf()
+        {
+            while (current != nullptr && current->FirstChildElement() != nullptr)
+            {
+                current = current->FirstChildElement();
+                depth++;
+            }
+        }
+
+        Element* top;
+        Element* current;
+        Order order;
+        int depth = 0;
+        bool skipChildren = false;
+    };
+
+    using ElementCursor = BasicElementCursor<tinyxml2::XMLElement>;
+    using ConstElementCursor = BasicElementCursor<const tinyxml2::XMLElement>;
+}
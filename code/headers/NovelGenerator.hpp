@@ -0,0 +1,37 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+namespace xmlEditor
+{
+    // Forma de la novela generada
+    struct NovelOptions
+    {
+        // Tamaño aproximado del archivo; se termina el capítulo en curso al llegar a él
+        std::uint64_t targetBytes = 64ull * 1024 * 1024;
+
+        // Opciones de cada decisión
+        int branching = 2;
+
+        // Misma semilla, mismo archivo en cualquier plataforma
+        std::uint32_t seed = 1;
+    };
+
+    // Resultado de la generación
+    struct GeneratedNovel
+    {
+        std::uint64_t bytes = 0;
+        std::uint64_t chapters = 0;
+        std::uint64_t elements = 0;
+    };
+
+    // Escribe una novela con la estructura de binaries/Test.xml
+    // (capitulo/parrafo/personaje/opcion/accion/goto) para medir el editor
+    // con archivos del tamaño de los de producción. El archivo se escribe
+    // por partes, así que puede ser mayor que la memoria.
+    GeneratedNovel GenerateNovel(const std::string& filePath, const NovelOptions& options);
+}
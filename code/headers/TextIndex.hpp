@@ -0,0 +1,126 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#pragma once
+
+#include <string>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "../headers/tinyxml2.h"
+#include "../headers/TrigramIndex.hpp"
+
+namespace xmlEditor
+{
+    // Resultado de una búsqueda aproximada: el elemento y la suma de las distancias de edición de
+    // las palabras de la consulta a las más parecidas de su texto (0 = todas exactas)
+    struct FuzzyMatch
+    {
+        tinyxml2::XMLElement* element;
+        int distance;
+    };
+
+    // Índice de palabras del texto de los elementos (el de los propios nodos de texto, no el de
+    // sus hijos). Para cada palabra guarda los elementos en los que aparece, en el orden del
+    // documento, y para cada elemento sus palabras en orden, con lo que se comprueban las frases
+    // sin volver a leer el texto. Las palabras se guardan en minúsculas y sin tildes (la ñ se conserva).
+    // El vocabulario tiene además un índice de trigramas para las búsquedas aproximadas.
+    class TextIndex {
+
+    public:
+        // Constructor
+        TextIndex();
+
+        // Destructor
+        ~TextIndex();
+
+        // Vacía el índice
+        void Clear();
+
+        // Añade el texto de elementos seguidos en el orden del documento (un nodo o un subárbol).
+        // Con varios hilos (0 = uno por núcleo) cada hilo lee un tramo seguido de la lista.
+        void Add(const std::vector<tinyxml2::XMLElement*>& elements, unsigned int threads = 1);
+
+        // Vuelve a leer el texto de elementos que han cambiado, en cualquier orden (por ejemplo, tras
+        // reemplazar en todo el documento). Los que ya estaban conservan su posición, así que cada
+        // lista de palabras se corrige una sola vez aunque cambien muchos.
+        void Update(const std::vector<tinyxml2::XMLElement*>& elements, unsigned int threads = 1);
+
+        // Quita el texto de los elementos (antes de cambiarlo o de borrarlos)
+        void Remove(const std::vector<tinyxml2::XMLElement*>& elements);
+
+        // Elementos cuyo texto contiene las palabras de la consulta seguidas. Una palabra
+        // terminada en '*' vale por cualquiera que empiece así. En el orden del documento.
+        std::vector<tinyxml2::XMLElement*> Find(const std::string& query) const;
+
+        // Elementos cuyo texto tiene, para cada palabra de la consulta, una parecida (a la distancia
+        // de TrigramIndex::MaxDistanceFor o menos), en cualquier orden. Van de la menor suma de
+        // distancias a la mayor y, con la misma, en el orden del documento; como mucho maxResults.
+        // Las palabras se miran de la más cercana a la más lejana: al llegar a deadline devuelve
+        // lo que lleva, que son los mejores de lo visto.
+        std::vector<FuzzyMatch> FindFuzzy(const std::string& query, std::size_t maxResults,
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()) const;
+
+        // Palabras de un texto tal y como se guardan en el índice
+        static std::vector<std::string> Tokenize(const char* text);
+
+        // Elementos con texto y palabras indexadas
+        std::size_t GetElementCount() const;
+        std::size_t GetWordCount() const;
+
+    private:
+        using TermId = std::uint32_t;
+
+        // Posición de un elemento: crece con el orden del documento y deja huecos para los
+        // elementos que se añadan en medio
+        using Order = std::uint64_t;
+
+        struct Entry
+        {
+            Order order;
+            std::vector<TermId> words;
+        };
+
+        struct Posting
+        {
+            Order order;
+            tinyxml2::XMLElement* element;
+        };
+
+        // Lee el texto de los elementos (con varios hilos) y lo añade al índice con la posición
+        // de cada uno, que tiene que ir en aumento
+        void Insert(const std::vector<tinyxml2::XMLElement*>& elements, const std::vector<Order>& orders, unsigned int threads);
+
+        // Identificador de una palabra; las nuevas se añaden al vocabulario
+        TermId TermFor(const std::string& word);
+
+        // Posición del elemento indexado más cercano antes (0 si no hay) o después (NoOrder si no hay)
+        Order OrderBefore(const tinyxml2::XMLElement* element) const;
+        Order OrderAfter(const tinyxml2::XMLElement* element) const;
+
+        // Reparte otra vez las posiciones con huecos iguales cuando uno se ha llenado
+        void Renumber(tinyxml2::XMLElement* root);
+
+        // Palabras del vocabulario que empiezan por prefix
+        std::vector<TermId> TermsWithPrefix(const std::string& prefix) const;
+
+        // Vocabulario: cada palabra con su identificador y al revés
+        std::unordered_map<std::string, TermId> terms;
+        std::vector<std::string> termNames;
+
+        // Trigramas del vocabulario, con el identificador de cada palabra
+        TrigramIndex termTrigrams;
+
+        // Elementos en los que aparece cada palabra, una vez cada uno y por orden de posición
+        std::vector<std::vector<Posting>> postings;
+
+        // Posición y palabras (en el orden del texto) de cada elemento con texto
+        std::unordered_map<const tinyxml2::XMLElement*, Entry> entries;
+        std::size_t wordCount = 0;
+
+        // Vocabulario ordenado para buscar prefijos; se completa al buscar si hay palabras nuevas
+        mutable std::vector<TermId> sortedTerms;
+    };
+}
@@ -0,0 +1,65 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace xmlEditor
+{
+    // Índice de trigramas para buscar palabras parecidas: cada palabra se guarda con un
+    // identificador y se parte en grupos de tres bytes seguidos (con dos huecos al principio y al
+    // final). Una palabra a distancia de edición k de otra comparte con ella casi todos sus
+    // trigramas, porque cada cambio rompe como mucho tres; con eso se descartan casi todas las
+    // palabras y solo se calcula la distancia de las que quedan. Las palabras se comparan byte a
+    // byte, así que se guardan ya en minúsculas y sin tildes (como las del índice de palabras).
+    class TrigramIndex {
+
+    public:
+        struct Match
+        {
+            std::uint32_t id;
+            int distance;
+        };
+
+        // Vacía el índice
+        void Clear();
+
+        // Añade una palabra; cada identificador se añade una sola vez
+        void Add(std::uint32_t id, const std::string& word);
+
+        // Palabras a distancia de edición maxDistance o menos, de la más cercana a la más lejana
+        // (y por identificador con la misma distancia)
+        std::vector<Match> Find(const std::string& word, int maxDistance) const;
+
+        // Palabra guardada con un identificador
+        const std::string& GetWord(std::uint32_t id) const;
+
+        // Palabras guardadas
+        std::size_t GetWordCount() const;
+
+        // Distancia que se admite para una palabra de ese largo: ninguna con dos letras o menos,
+        // una hasta cinco y dos a partir de seis
+        static int MaxDistanceFor(std::size_t length);
+
+        // Distancia de edición (Levenshtein) entre dos palabras; si pasa de limit devuelve limit + 1
+        static int EditDistance(const std::string& a, const std::string& b, int limit);
+
+    private:
+        using Trigram = std::uint32_t;
+
+        // Trigramas de una palabra con los huecos, uno por posición (puede repetir)
+        static void Split(const std::string& word, std::vector<Trigram>& trigrams);
+
+        // Palabras en las que aparece cada trigrama, una vez cada una
+        std::unordered_map<Trigram, std::vector<std::uint32_t>> lists;
+
+        // Cada palabra en la posición de su identificador; hay huecos vacíos si no son seguidos
+        std::vector<std::string> words;
+        std::size_t wordCount = 0;
+    };
+}
@@ -0,0 +1,19 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace xmlEditor
+{
+    // Número de hilos a usar (0 = uno por núcleo)
+    unsigned int ResolveThreadCount(unsigned int threads);
+
+    // Ejecuta task(i) para cada i en [0, count) repartiendo los índices entre varios hilos:
+    // cada hilo toma el siguiente índice libre, así que los trabajos se empiezan en orden.
+    // El hilo que llama también trabaja. Si una tarea lanza una excepción no se empiezan
+    // más y se relanza la primera al terminar las que estaban en marcha.
+    void RunParallel(std::size_t count, unsigned int threads, const std::function<void(std::size_t)>& task);
+}
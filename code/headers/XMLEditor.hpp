@@ -1,56 +1,314 @@
-// Autor: felixhmy 
-// Todos los derechos reservados © 2025 
-
-#pragma once
-
-#include <string>
-#include "..\headers\tinyxml2.h"
-
-namespace xmlEditor
-{
-    class XMLEditor {
-
-    public:
-        // Constructor
-        XMLEditor();
-
-        // Destructor
-        ~XMLEditor();
-
-        // Abre el archivo XML y carga su contenido
-        void OpenFile(const std::string& filePath);
-
-        // Crear un nuevo archivo XML con el nombre de nodo raíz proporcionado
-        void CreateNew(const std::string& rootName);
-
-        // Obtener el nodo raíz
-        tinyxml2::XMLElement* GetRootNode();
-
-        // Obtener un nodo hijo por su nombre
-        tinyxml2::XMLElement* GetChildNode(tinyxml2::XMLElement* parentNode, const std::string& nodeName);
-
-        // Añadir un nuevo nodo hijo
-        tinyxml2::XMLElement* AddChildNode(tinyxml2::XMLElement* parentNode, const std::string& nodeName);
-
-        // Eliminar un nodo hijo
-        void RemoveChildNode(tinyxml2::XMLElement* parentNode, tinyxml2::XMLElement* childNode);
-
-        // Modificar el valor de un nodo
-        void ModifyNodeValue(tinyxml2::XMLElement* node, const std::string& newValue);
-
-        // Añadir o modificar un atributo a un nodo
-        void ModifyNodeAttribute(tinyxml2::XMLElement* node, const std::string& attributeName, const std::string& attributeValue);
-
-        // Guardar el archivo XML con los cambios
-        void SaveFile(const std::string& filePath);
-        void SaveFileAs(const std::string& newFilePath);
-
-        // Obtener un nodo por su nombre
-        tinyxml2::XMLElement* GetNodeByName(const std::string& nodeName);
-        tinyxml2::XMLElement* GetNodeByNameRecursive(tinyxml2::XMLElement* startNode, const std::string& nodeName);
-
-    private:
-        // El documento XML en memoria
-        tinyxml2::XMLDocument xmlDoc;
-    };
-}
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "../headers/tinyxml2.h"
+#include "../headers/ElementCursor.hpp"
+#include "../headers/TextIndex.hpp"
+
+namespace xmlEditor
+{
+    // Opciones de lectura de un archivo XML
+    struct LoadOptions
+    {
+        // Proyecta el archivo en memoria (copia privada) en lugar de leerlo a un buffer. Es más
+        // rápido, pero el archivo queda abierto hasta guardar o cerrar: en Windows otros programas no
+        // pueden escribirlo y si otro lo recorta el proceso cae. Solo para lecturas de un momento.
+        bool memoryMapped = false;
+
+        // Solo lee los capítulos (hijos del nodo raíz) con sus atributos; su contenido
+        // se lee la primera vez que se accede a él
+        bool lazyChapters = false;
+
+        // Hilos para leer los capítulos en paralelo (0 = uno por núcleo, 1 = sin hilos).
+        // Con lazyChapters se usan al leer todos los capítulos pendientes antes de guardar.
+        unsigned int parseThreads = 1;
+
+        // Se llama cada pocos miles de nodos con los bytes leídos y el total;
+        // si devuelve false la carga se cancela. Puede llamarse desde otro hilo.
+        std::function<bool(std::size_t parsedBytes, std::size_t totalBytes)> progress;
+    };
+
+    // Medidas de la última lectura, para comparar los modos de carga
+    struct LoadStats
+    {
+        bool memoryMapped = false;
+        std::size_t bytes = 0;
+        double seconds = 0.0;
+        double megabytesPerSecond = 0.0;
+        std::size_t peakResidentBytes = 0;
+    };
+
+    // Un personaje del reparto: sus intervenciones (nodos personaje) y las palabras de su texto
+    struct CharacterStats
+    {
+        std::string name;
+        std::size_t lines = 0;
+        std::size_t words = 0;
+    };
+
+    // Un cambio de buscar y reemplazar: uno de los textos de un nodo (attribute vacío) o el valor de
+    // uno de sus atributos, con el valor anterior y el nuevo. textPosition dice cuál de los textos
+    // del nodo, contando solo los textos: un nodo con hijos entre medias tiene varios.
+    struct Replacement
+    {
+        tinyxml2::XMLElement* node = nullptr;
+        std::string attribute;
+        std::string before;
+        std::string after;
+        std::size_t textPosition = 0;
+    };
+
+    // Opciones de buscar y reemplazar
+    struct ReplaceOptions
+    {
+        // Expresión regular (ECMAScript) en lugar de texto literal; el reemplazo admite $1, $&...
+        bool regex = false;
+
+        // Sin distinguir mayúsculas solo se igualan las letras ASCII
+        bool matchCase = true;
+
+        // Dónde se busca: el texto de los nodos y los valores de sus atributos
+        bool text = true;
+        bool attributes = true;
+
+        // Hilos para buscar (0 = uno por núcleo)
+        unsigned int threads = 0;
+    };
+
+    class XMLEditor {
+
+    public:
+        // Constructor
+        XMLEditor();
+
+        // Destructor
+        ~XMLEditor();
+
+        // Abre el archivo XML y carga su contenido
+        void OpenFile(const std::string& filePath, const LoadOptions& options = LoadOptions());
+
+        // Datos de rendimiento de la última llamada a OpenFile
+        const LoadStats& GetLoadStats() const;
+
+        // Pico de memoria residente del proceso, en bytes
+        static std::size_t PeakResidentBytes();
+
+        // Memoria residente actual del proceso, en bytes
+        static std::size_t ResidentBytes();
+
+        // Crear un nuevo archivo XML con el nombre de nodo raíz proporcionado
+        void CreateNew(const std::string& rootName);
+
+        // Obtener el nodo raíz
+        tinyxml2::XMLElement* GetRootNode();
+
+        // Lee el contenido de un capítulo cargado en modo diferido
+        void ExpandNode(tinyxml2::XMLElement* node);
+        bool IsDeferred(const tinyxml2::XMLElement* node) const;
+
+        // Indica si el nodo pertenece a este documento
+        bool Contains(const tinyxml2::XMLNode* node) const;
+
+        // Obtener un nodo hijo por su nombre
+        tinyxml2::XMLElement* GetChildNode(tinyxml2::XMLElement* parentNode, const std::string& nodeName);
+
+        // Añadir un nuevo nodo hijo
+        tinyxml2::XMLElement* AddChildNode(tinyxml2::XMLElement* parentNode, const std::string& nodeName);
+
+        // Eliminar un nodo hijo
+        void RemoveChildNode(tinyxml2::XMLElement* parentNode, tinyxml2::XMLElement* childNode);
+
+        // Cambiar el nombre de un nodo
+        void RenameNode(tinyxml2::XMLElement* node, const std::string& newName);
+
+        // Modificar el valor de un nodo
+        void ModifyNodeValue(tinyxml2::XMLElement* node, const std::string& newValue);
+
+        // Añadir o modificar un atributo a un nodo
+        void ModifyNodeAttribute(tinyxml2::XMLElement* node, const std::string& attributeName, const std::string& attributeValue);
+
+        // Guardar el archivo XML con los cambios
+        void SaveFile(const std::string& filePath);
+        void SaveFileAs(const std::string& newFilePath);
+
+        // Nodos cambiados con las funciones de edición desde que se abrió o se guardó el archivo.
+        // Los cambios se escriben en el documento al momento, así que guardar solo serializa.
+        bool IsModified() const;
+        const std::unordered_set<const tinyxml2::XMLElement*>& GetModifiedNodes() const;
+
+        // Archivo del documento: el último abierto o guardado (vacío si es nuevo)
+        const std::string& GetFilePath() const;
+
+        // Obtener un nodo por su nombre: el primero en el orden del documento, o el primero
+        // dentro de startNode (incluido). Usan el índice de nombres, sin recorrer el documento.
+        tinyxml2::XMLElement* GetNodeByName(const std::string& nodeName);
+        tinyxml2::XMLElement* GetNodeByNameRecursive(tinyxml2::XMLElement* startNode, const std::string& nodeName);
+
+        // Todos los nodos con ese nombre, en el orden del documento
+        const std::vector<tinyxml2::XMLElement*>& GetNodesByName(const std::string& nodeName);
+
+        // Índices de valor de atributo: para un par (elemento, atributo), los nodos con cada valor,
+        // en el orden del documento. Se indexan capitulo/numero, chapter/number, opcion/id,
+        // personaje/nombre y capitulo/titulo; otros pares se añaden con AddAttributeIndex o la
+        // primera vez que se buscan.
+        void AddAttributeIndex(const std::string& nodeName, const std::string& attributeName);
+        bool HasAttributeIndex(const std::string& nodeName, const std::string& attributeName) const;
+        tinyxml2::XMLElement* GetNodeByAttribute(const std::string& nodeName, const std::string& attributeName, const std::string& attributeValue);
+        const std::vector<tinyxml2::XMLElement*>& GetNodesByAttribute(const std::string& nodeName, const std::string& attributeName,
+            const std::string& attributeValue);
+
+        // Reparto de personajes: cada valor de personaje/nombre con sus intervenciones, en el orden
+        // del documento, y el número de palabras de su texto. Se mantiene con el índice de ese par
+        // al abrir, al editar y al leer cada capítulo diferido, así que no recorre el documento ni
+        // lee los capítulos pendientes: cuenta los que ya están leídos. GetCharacters va por nombre.
+        std::vector<CharacterStats> GetCharacters();
+        const std::vector<tinyxml2::XMLElement*>& GetCharacterLines(const std::string& characterName);
+
+        // Búsqueda en el texto de los nodos con el índice de palabras: los nodos cuyo texto contiene
+        // las palabras de la consulta seguidas, sin distinguir mayúsculas ni tildes. Una palabra
+        // terminada en '*' vale por cualquiera que empiece así. En el orden del documento.
+        std::vector<tinyxml2::XMLElement*> FindText(const std::string& query);
+
+        // Búsqueda aproximada, para consultas con faltas o con un nombre mal recordado: los nodos
+        // cuyo texto tiene palabras parecidas a las de la consulta (TextIndex::FindFuzzy) y los
+        // personajes y capítulos cuyo nombre o título se parece a la consulta entera. Van de menor
+        // a mayor distancia de edición y, con la misma, primero los de nombre o título; como mucho
+        // maxResults. Al llegar a deadline devuelve lo que lleva (para responder mientras se escribe).
+        std::vector<FuzzyMatch> FindFuzzy(const std::string& query, std::size_t maxResults = 100,
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+        // Buscar y reemplazar en todo el documento. FindReplacements busca con varios hilos, cada uno
+        // con un tramo de nodos, y devuelve los cambios en el orden del documento sin tocarlo (para
+        // enseñarlos antes). Lanza std::invalid_argument si el texto buscado está vacío o la
+        // expresión regular no es válida.
+        std::vector<Replacement> FindReplacements(const std::string& pattern, const std::string& replacement,
+            const ReplaceOptions& options = ReplaceOptions());
+
+        // Aplica los cambios, en el orden del documento como los da FindReplacements, de una vez: cada
+        // índice se corrige una sola vez para todos. Se saltan los que ya no coinciden con el valor
+        // del nodo y los de nodos que ya no están en el documento. Devuelve los aplicados, que se
+        // deshacen juntos.
+        std::vector<Replacement> ApplyReplacements(const std::vector<Replacement>& changes);
+
+        // Deshace el último bloque de reemplazos y devuelve sus cambios tal y como se han deshecho
+        // (after es el valor que vuelve a tener cada nodo). Solo se deshacen los reemplazos: borrar
+        // nodos, cambiar a mano un texto o un atributo o abrir otro archivo vacía el historial.
+        bool CanUndo() const;
+        std::vector<Replacement> Undo();
+
+        // Construye el índice de palabras si aún no existe (threads: 0 = uno por núcleo).
+        // Prepara también los trigramas de nombres y títulos para la búsqueda aproximada.
+        void BuildTextIndex(unsigned int threads = 1);
+        const TextIndex& GetTextIndex() const;
+
+        // El mismo índice construido capítulo a capítulo desde otro hilo, mientras se muestra el
+        // documento. BeginTextIndex, en el hilo del documento, empieza el índice con el nodo raíz y
+        // devuelve sus hijos (los capítulos) en orden. ReadChapter lee un capítulo pendiente sin
+        // cambiar el documento, así que puede ir en el otro hilo, y AttachChapter lo pone en su
+        // sitio en el hilo del documento, con sus nombres, atributos y personajes en los índices.
+        // IndexChapterText, en el otro hilo, añade el texto de un capítulo ya leído, en orden, y
+        // FinishTextIndex da el índice por construido. Mientras tanto no se cambia el documento, no
+        // se busca en él ni se leen capítulos con ExpandNode.
+        std::vector<tinyxml2::XMLElement*> BeginTextIndex();
+        tinyxml2::XMLNode* ReadChapter(const tinyxml2::XMLElement* chapter) const;
+        void AttachChapter(tinyxml2::XMLElement* chapter, tinyxml2::XMLNode* content);
+        void IndexChapterText(tinyxml2::XMLElement* chapter);
+        void FinishTextIndex();
+
+    private:
+        // Suelta la proyección del archivo si se va a sobrescribir
+        void PrepareSaveTarget(const std::string& filePath);
+
+        // Marca un nodo como cambiado; ForgetModified quita un nodo borrado y sus descendientes
+        void MarkModified(const tinyxml2::XMLElement* node);
+        void ForgetModified(const tinyxml2::XMLElement* node);
+
+        // Índice de nombres. IndexElements y UnindexElements reciben elementos seguidos en el
+        // orden del documento (un nodo o un subárbol) y los ponen o quitan de sus listas.
+        void BuildNameIndex();
+        void IndexElements(const std::vector<tinyxml2::XMLElement*>& elements);
+        void UnindexElements(const std::vector<tinyxml2::XMLElement*>& elements);
+
+        // Índice de un par (elemento, atributo). Con countWords guarda además las palabras del
+        // texto de los nodos de cada valor (el reparto de personajes). Con fuzzy los valores entran
+        // en la búsqueda aproximada: sus trigramas se rehacen al buscar si hay valores nuevos o
+        // quitados; fuzzyValues tiene el valor de cada identificador del índice de trigramas.
+        struct AttributeIndex
+        {
+            std::string nodeName;
+            std::string attributeName;
+            std::unordered_map<std::string, std::vector<tinyxml2::XMLElement*>> nodes;
+            bool countWords = false;
+            std::unordered_map<std::string, std::size_t> words;
+            bool fuzzy = false;
+            TrigramIndex valueTrigrams;
+            std::vector<std::string> fuzzyValues;
+            bool valueTrigramsReady = false;
+        };
+
+        // Índices de atributo: se rehacen con el de nombres y se actualizan con cada elemento o valor
+        void BuildAttributeIndex(AttributeIndex& index);
+        void IndexAttribute(AttributeIndex& index, tinyxml2::XMLElement* element, const char* value);
+        void UnindexAttribute(AttributeIndex& index, tinyxml2::XMLElement* element, const char* value);
+
+        // Lo mismo para muchos nodos a la vez, en el orden del documento y con el valor que tienen
+        // al llamar: la lista de cada valor se recorre una sola vez
+        void IndexAttributes(AttributeIndex& index, const std::vector<tinyxml2::XMLElement*>& elements);
+        void UnindexAttributes(AttributeIndex& index, const std::vector<tinyxml2::XMLElement*>& elements);
+        AttributeIndex* FindAttributeIndex(const std::string& nodeName, const std::string& attributeName);
+        void BuildValueTrigrams(AttributeIndex& index);
+
+        // Quita (o vuelve a sumar) las palabras del texto de un nodo en los índices que las cuentan
+        void CountIndexedWords(const tinyxml2::XMLElement* node, bool add);
+
+        // Escribe los cambios de un reemplazo en el documento y corrige los índices una vez para todos
+        void WriteReplacements(const std::vector<Replacement>& changes);
+
+        // Lee los capítulos pendientes antes de una búsqueda o de guardar
+        void ExpandAllNodes();
+
+        // Elementos de un subárbol en el orden del documento
+        static std::vector<tinyxml2::XMLElement*> SubtreeElements(tinyxml2::XMLElement* node, bool includeNode);
+
+        // Indica si a va antes que b en el documento
+        static bool IsBefore(const tinyxml2::XMLNode* a, const tinyxml2::XMLNode* b);
+
+        // El documento XML en memoria
+        tinyxml2::XMLDocument xmlDoc;
+
+        // Archivo cargado y medidas de la carga
+        std::string loadedFilePath;
+        LoadStats loadStats;
+
+        // Archivo abierto o guardado por última vez y nodos cambiados desde entonces
+        std::string currentFilePath;
+        std::unordered_set<const tinyxml2::XMLElement*> modifiedNodes;
+
+        // Bloques de reemplazos que se pueden deshacer, el último al final
+        std::vector<std::vector<Replacement>> undoHistory;
+
+        // Elementos de cada nombre en el orden del documento y si quedan capítulos sin leer
+        std::unordered_map<std::string, std::vector<tinyxml2::XMLElement*>> nameIndex;
+        bool pendingChapters = false;
+        // En un deque para que las referencias que devuelven las búsquedas sigan valiendo al añadir
+        // un índice nuevo (cualquier búsqueda de un par sin índice lo añade)
+        std::deque<AttributeIndex> attributeIndexes;
+
+        // Índice de palabras del texto, si ya se construyó, y los hilos con los que se construyó
+        TextIndex textIndex;
+        bool textIndexReady = false;
+        unsigned int textIndexThreads = 1;
+
+        // Documento de tinyxml2 en el que ReadChapter lee los capítulos; es del propio documento
+        tinyxml2::XMLDocument* chapterWorkspace = nullptr;
+    };
+}
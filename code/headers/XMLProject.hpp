@@ -0,0 +1,60 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "XMLEditor.hpp"
+
+namespace xmlEditor
+{
+    // Novela repartida en varios archivos XML (uno por capítulo o por ruta).
+    // Cada archivo se carga en su propio XMLEditor y los archivos se leen en paralelo.
+    class XMLProject {
+
+    public:
+        // Constructor
+        XMLProject();
+
+        // Destructor
+        ~XMLProject();
+
+        // Abre una carpeta (todos sus .xml, en orden alfabético) o un archivo de proyecto:
+        // un archivo de texto con una ruta por línea, relativa a la carpeta del propio archivo.
+        // Las líneas vacías y las que empiezan por '#' se ignoran; una ruta absoluta o que sale
+        // de la carpeta (con "..") lanza std::runtime_error.
+        // options.parseThreads indica cuántos archivos se leen a la vez (0 = uno por núcleo);
+        // options.progress recibe los bytes leídos de todos los archivos.
+        void Open(const std::string& path, const LoadOptions& options = LoadOptions());
+
+        // Lista los archivos que abriría Open, con la ruta tal y como se mostrará
+        static std::vector<std::string> ListFiles(const std::string& path, std::vector<std::string>& relativePaths);
+
+        // Documentos del proyecto, en el orden de la carpeta o del archivo de proyecto
+        std::size_t GetDocumentCount() const;
+        XMLEditor& GetDocument(std::size_t index);
+        const std::string& GetRelativePath(std::size_t index) const;
+
+        // Documento al que pertenece un nodo (nullptr si no es de este proyecto)
+        XMLEditor* FindDocument(const tinyxml2::XMLElement* node);
+
+        // Nombre del proyecto (la carpeta o el archivo de proyecto)
+        const std::string& GetName() const;
+
+        // Guarda cada documento en la carpeta indicada con su ruta relativa.
+        // Los documentos sin cambios que ya están en ese archivo se dejan como están.
+        // Si alguna ruta quedara fuera de la carpeta no se guarda nada y se lanza std::runtime_error.
+        void SaveAll(const std::string& directory);
+
+        // Medidas de la carga de todos los archivos
+        const LoadStats& GetLoadStats() const;
+
+    private:
+        std::vector<std::unique_ptr<XMLEditor>> documents;
+        std::vector<std::string> relativePaths;
+        std::string name;
+        LoadStats loadStats;
+    };
+}
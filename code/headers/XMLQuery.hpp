@@ -0,0 +1,124 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <vector>
+#include "../headers/tinyxml2.h"
+#include "../headers/XMLEditor.hpp"
+
+namespace xmlEditor
+{
+    // Consulta con un subconjunto de XPath. Se compila una vez y se puede usar con cualquier
+    // documento, también desde varios hilos a la vez con documentos distintos.
+    //   /a/b        b hijos de a, con a el nodo raíz      //a   a en cualquier nivel
+    //   a//b        b dentro de a a cualquier nivel      *     cualquier nombre
+    //   [@x]        con el atributo x
+    //   [@x='v']    también !=, <, <=, > y >=; con un número se compara como número
+    //   [@x='v' and @y>2]
+    //   [2]         el segundo de los hermanos que cumplen lo anterior; [last()] el último
+    // Una ruta que no empieza por '/' se lee desde el documento, como si empezara por él.
+    class XMLQuery {
+
+    public:
+        // Compila la expresión; lanza std::invalid_argument si no es válida
+        explicit XMLQuery(const std::string& expression);
+
+        // Destructor
+        ~XMLQuery();
+
+        // Nodos del documento que cumplen la consulta, en el orden del documento.
+        // Si el último paso tiene nombre y no hay posiciones, parte del índice de nombres (o de uno
+        // de atributos que ya tenga el documento) y comprueba los padres de cada candidato; si no,
+        // recorre el documento una vez sin entrar en las ramas que ya no pueden cumplirla.
+        std::vector<tinyxml2::XMLElement*> Run(XMLEditor& editor) const;
+
+        // Siempre con el recorrido, aunque se puedan usar los índices
+        std::vector<tinyxml2::XMLElement*> RunTraversal(XMLEditor& editor) const;
+
+        // Indica si Run usa los índices
+        bool UsesIndexes() const;
+
+        const std::string& GetExpression() const;
+
+    private:
+        enum class Axis
+        {
+            Child,
+            Descendant
+        };
+
+        enum class Comparison
+        {
+            Exists,
+            Equal,
+            NotEqual,
+            Less,
+            LessEqual,
+            Greater,
+            GreaterEqual
+        };
+
+        struct Condition
+        {
+            std::string attribute;
+            Comparison comparison = Comparison::Exists;
+            std::string value;
+            bool numeric = false;
+            double number = 0.0;
+        };
+
+        // Un predicado es una posición ([2], [last()]) o una lista de condiciones unidas por "and".
+        // Las posiciones se cuentan entre los hermanos con un contador por predicado (slot).
+        struct Predicate
+        {
+            std::vector<Condition> conditions;
+            int position = 0;
+            bool last = false;
+            std::size_t slot = 0;
+        };
+
+        struct Step
+        {
+            Axis axis = Axis::Child;
+            std::string name;
+            std::vector<Predicate> predicates;
+        };
+
+        // Contadores de posición de los hijos de un nodo: los que van y el total (para last())
+        struct PositionCounter
+        {
+            int count = 0;
+            int total = -1;
+        };
+
+        // Lectura de la expresión
+        void Parse();
+        Predicate ParsePredicate();
+        Condition ParseCondition();
+        std::string ParseName();
+        std::string ParseLiteral(bool& numeric);
+        void SkipSpaces();
+        bool Accept(const char* token);
+        [[noreturn]] void Fail(const char* reason) const;
+
+        // Comprobaciones sobre un elemento
+        static bool MatchesCondition(const tinyxml2::XMLElement* element, const Condition& condition);
+        static bool MatchesName(const tinyxml2::XMLElement* element, const Step& step);
+        bool MatchesPredicates(const tinyxml2::XMLElement* element, const Step& step, std::size_t count) const;
+        bool MatchesStep(const tinyxml2::XMLElement* element, const Step& step, std::vector<PositionCounter>& counters) const;
+
+        // Indica si los padres de un elemento que cumple el paso k cumplen los pasos anteriores
+        bool MatchesPath(const tinyxml2::XMLElement* element, std::size_t k) const;
+
+        std::string expression;
+        std::size_t cursor = 0;
+        std::vector<Step> steps;
+        std::size_t positionSlots = 0;
+
+        // Sin posiciones y con nombre en el último paso se puede partir de los índices
+        bool indexable = false;
+    };
+}
@@ -0,0 +1,113 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+#include "../headers/tinyxml2.h"
+
+namespace xmlEditor
+{
+    // Eventos que produce el lector
+    enum class StreamEvent
+    {
+        StartElement,
+        Text,
+        EndElement,
+        EndDocument
+    };
+
+    class XMLStreamReader;
+
+    // Receptor de eventos para el modo push. Devolver false detiene la lectura.
+    class XMLStreamHandler {
+
+    public:
+        virtual ~XMLStreamHandler() { }
+
+        virtual bool OnStartElement(const XMLStreamReader&) { return true; }
+        virtual bool OnText(const XMLStreamReader&) { return true; }
+        virtual bool OnEndElement(const XMLStreamReader&) { return true; }
+    };
+
+    // Lector secuencial de XML que no construye el documento en memoria.
+    // Usa los mismos escáneres de tinyxml2 (StrPair, XMLUtil) sobre una ventana
+    // del archivo que solo crece hasta el tamaño del mayor elemento o texto,
+    // así que sirve para archivos más grandes que la memoria.
+    class XMLStreamReader {
+
+    public:
+        // Constructor
+        explicit XMLStreamReader(std::size_t chunkSize = 64 * 1024);
+
+        // Destructor
+        ~XMLStreamReader();
+
+        // Abre el archivo XML para leerlo por eventos
+        void Open(const std::string& filePath);
+        void Close();
+
+        // Modo pull: avanza al siguiente evento. Los datos del evento anterior dejan de ser válidos.
+        StreamEvent Next();
+
+        // Modo push: lee el archivo entero enviando cada evento al receptor
+        void Run(XMLStreamHandler& handler);
+
+        // Datos del evento actual
+        const char* Name() const;
+        const char* Text() const;
+        int AttributeCount() const;
+        const char* AttributeName(int index) const;
+        const char* AttributeValue(int index) const;
+        const char* Attribute(const char* name) const;
+
+        // Profundidad del elemento actual (1 para el nodo raíz)
+        int Depth() const;
+        int LineNum() const;
+        std::uint64_t BytesRead() const;
+
+    private:
+        struct StreamAttribute
+        {
+            tinyxml2::StrPair name;
+            tinyxml2::StrPair value;
+        };
+
+        // Resultado de intentar leer el siguiente token de la ventana
+        enum class TokenResult { Event, Skipped, NeedMoreData };
+
+        TokenResult ParseToken(StreamEvent& event);
+        TokenResult ParseTag(char* p, StreamEvent& event);
+        bool Refill();
+        [[noreturn]] void Fail(const std::string& message) const;
+
+        // Archivo y ventana de lectura
+        std::ifstream file;
+        std::vector<char> buffer;
+        std::size_t chunkSize;
+        std::size_t position;
+        std::size_t filled;
+        std::uint64_t bytesRead;
+        bool endOfFile;
+
+        // Estado del evento actual
+        mutable tinyxml2::StrPair name;
+        mutable tinyxml2::StrPair text;
+        std::vector<std::unique_ptr<StreamAttribute>> attributes;
+        int attributeCount;
+        bool pendingEnd;
+        bool restoreTag;
+        int lineNum;
+        int parseLineNum;
+
+        StreamEvent current;
+
+        // Elementos abiertos, para comprobar las etiquetas de cierre
+        std::vector<std::string> openElements;
+        std::string closedName;
+    };
+}
@@ -0,0 +1,195 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QPersistentModelIndex>
+#include <QStringList>
+#include <QTimer>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <memory>
+#include "XMLEditor.hpp"
+
+//Modelo del árbol que lee directamente el documento de tinyxml2.
+//No copia los nombres, textos ni atributos: data() los lee del XMLElement al pintar la fila.
+//Solo se guarda, para cada elemento cuyas filas se han pedido, la lista de sus filas.
+//Los elementos hijos se añaden por tandas (canFetchMore/fetchMore) según se despliega o se baja
+//por el árbol, así un capítulo con miles de párrafos no se lee entero al abrirlo. Las tandas que
+//faltan de los capítulos y de los nodos desplegados se añaden después en trozos de unos
+//milisegundos por vuelta del bucle de eventos, sin bloquear la vista.
+//
+//Cada elemento ocupa una sola fila: en la primera columna su nombre, en "Scene ID" y "Title" sus
+//atributos de identificador y de título y en "Content" su texto. Los hijos de la fila son sus
+//elementos hijos y, si el contenido del capítulo aún no se ha leído, una fila provisional.
+class XMLTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    //Tipos de fila
+    enum class RowKind
+    {
+        Project,
+        Element,
+        Deferred
+    };
+
+    //Columnas de las filas de elemento
+    enum Column
+    {
+        NameColumn,
+        SceneIdColumn,
+        TitleColumn,
+        ContentColumn,
+        ColumnCount
+    };
+
+    //Constructor
+    explicit XMLTreeModel(QObject* parent = nullptr);
+
+    //Destructor
+    ~XMLTreeModel();
+
+    //Documentos que se muestran. Con nombre de proyecto cuelgan de una raíz común con ese nombre
+    //y documentPaths se muestra como ayuda de cada archivo.
+    void SetDocuments(const std::vector<xmlEditor::XMLEditor*>& documents, const QString& projectName = QString(),
+        const QStringList& documentPaths = QStringList());
+    void Clear();
+
+    //Vuelve a leer todas las filas después de cambiar el documento fuera del modelo
+    void Reload();
+
+    //Atributo que se muestra en la columna indicada (nullptr si no hay ninguno).
+    //"Scene ID" usa numero, number, id o capitulo y "Title" titulo, title, texto, nombre o name;
+    //si falta alguno se usa el primer atributo que no tenga columna.
+    static const tinyxml2::XMLAttribute* ColumnAttribute(const tinyxml2::XMLElement* element, int column);
+
+    //Datos de una fila. Cada fila de elemento apunta a su XMLElement, así que pasar de una
+    //fila a su nodo y de un nodo a su fila no depende del nombre ni recorre el documento.
+    RowKind KindOf(const QModelIndex& index) const;
+    tinyxml2::XMLElement* ElementAt(const QModelIndex& index) const;
+    QModelIndex IndexOfElement(tinyxml2::XMLElement* element) const;
+    xmlEditor::XMLEditor* DocumentOf(const tinyxml2::XMLElement* element) const;
+
+    //Índice de un elemento para mostrarlo, con las filas de sus padres listas
+    QModelIndex RevealElement(tinyxml2::XMLElement* element);
+
+    //Muestra solo estos elementos, con sus descendientes, y los padres que llevan hasta ellos
+    //(por ejemplo, las intervenciones de un personaje). Las filas se vuelven a leer.
+    void SetFilter(const std::vector<tinyxml2::XMLElement*>& elements);
+    void ClearFilter();
+    bool IsFiltered() const;
+
+    //Lee el contenido de un capítulo diferido y sustituye la fila provisional por sus filas
+    void ExpandDeferred(const QModelIndex& index);
+
+    //Añade poco a poco, con un temporizador, las filas que faltan del nodo (los capítulos de cada
+    //documento se añaden solos al cambiar de documentos)
+    void PopulateInBackground(const QModelIndex& parent);
+
+    //Añade o elimina un elemento en el documento y avisa a la vista solo de las filas de su padre,
+    //así no se pierden los nodos desplegados ni la posición de la vista.
+    //AddElement devuelve la fila del nuevo elemento y RemoveElement la de su padre.
+    QModelIndex AddElement(tinyxml2::XMLElement* parentElement, const std::string& name);
+    QModelIndex RemoveElement(tinyxml2::XMLElement* element);
+
+    //Avisa a la vista de que han cambiado el texto o los atributos de estos elementos (por ejemplo,
+    //al reemplazar en todo el documento). Solo las filas ya leídas: las demás leen los valores al pedirse.
+    void RefreshElements(const std::vector<tinyxml2::XMLElement*>& elements);
+
+    //QAbstractItemModel
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& index) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+signals:
+    //Se ha cambiado el documento desde el árbol: una celda editada o los elementos de
+    //RefreshElements. Leer un capítulo diferido no cuenta, aunque avise de su fila con dataChanged.
+    void DocumentEdited();
+
+private slots:
+    //Añade tandas de filas de los nodos pendientes durante unos milisegundos
+    void PopulateStep();
+
+private:
+    //Filas de un elemento
+    struct Rows
+    {
+        bool deferred = false;
+        //Quedan elementos hijos en el documento que aún no tienen fila
+        bool pending = false;
+        std::vector<tinyxml2::XMLElement*> elements;
+
+        int Count() const { return static_cast<int>(elements.size()) + (deferred ? 1 : 0); }
+    };
+
+    //Olvida todas las filas leídas; solo quedan las posiciones de las raíces
+    void ClearRows();
+
+    //Pone en cola los capítulos de todos los documentos
+    void PopulateDocuments();
+
+    //Filas del elemento; se leen del documento la primera vez que se piden
+    Rows& RowsOf(tinyxml2::XMLElement* element) const;
+
+    //Elemento del que cuelga la fila (nullptr en las filas superiores y en las de los archivos)
+    tinyxml2::XMLElement* ParentElementOf(const QModelIndex& index) const;
+    bool IsDocumentRow(const QModelIndex& index) const;
+    bool IsProjectMode() const;
+
+    //Guarda la posición de cada elemento entre los elementos hijos de su padre
+    void IndexPositions(const Rows& elementRows, std::size_t first) const;
+
+    //Añade a las filas los siguientes elementos hijos, como mucho count.
+    //AppendElements no avisa a la vista; FetchElements sí, con la fila del elemento en parent.
+    void AppendElements(tinyxml2::XMLElement* element, Rows& elementRows, std::size_t count) const;
+    void FetchElements(const QModelIndex& parent, tinyxml2::XMLElement* element, Rows& elementRows, std::size_t count);
+    std::vector<tinyxml2::XMLElement*> NextElements(tinyxml2::XMLElement* element, const Rows& elementRows, std::size_t count) const;
+
+    //Con filtro, indica si se muestran todos los hijos del elemento: es uno de los filtrados o está dentro de uno
+    bool ShowsAllChildren(const tinyxml2::XMLElement* element) const;
+
+    //Elementos hijos que se añaden de una vez
+    static constexpr std::size_t FetchBatchSize = 256;
+
+    //Tiempo máximo de cada trozo de PopulateStep, en milisegundos
+    static constexpr int PopulateSliceMilliseconds = 8;
+
+    //Olvida las filas guardadas de un elemento y de todos sus descendientes
+    void ForgetRows(const tinyxml2::XMLElement* element);
+
+    static QString ToQString(const char* text);
+
+    //Texto de ayuda con los atributos que no tienen columna
+    static QString OtherAttributes(const tinyxml2::XMLElement* element);
+
+    std::vector<xmlEditor::XMLEditor*> documents;
+    QString projectName;
+    QStringList documentPaths;
+    mutable std::unordered_map<const tinyxml2::XMLElement*, std::unique_ptr<Rows>> rows;
+
+    //Posición de cada elemento en el vector elements de su padre (o en documents si es una raíz);
+    //solo de los elementos cuyo padre tiene las filas leídas
+    mutable std::unordered_map<const tinyxml2::XMLElement*, std::size_t> positions;
+
+    //Filtro: elementos que se muestran enteros y sus padres, que solo muestran el camino hasta ellos
+    bool filtered = false;
+    std::unordered_set<const tinyxml2::XMLElement*> filterElements;
+    std::unordered_set<const tinyxml2::XMLElement*> filterPath;
+
+    //Nodos con filas por añadir; las filas persistentes siguen válidas aunque cambie el árbol
+    std::deque<QPersistentModelIndex> populateQueue;
+    QTimer* populateTimer;
+};
@@ -1,44 +1,169 @@
-// Autor: felixhmy 
-// Todos los derechos reservados © 2025 
-
-#pragma once
-
-#include <QtWidgets/QMainWindow>
-#include <QStandardItemModel>
-#include <QStandardItem>
-#include <QFileDialog>
-#include <QMessageBox>
-#include <QInputDialog>
-#include "ui_XMLsEditorInteractiveNovels.h"
-#include "XMLEditor.hpp"
-#include <map>
-
-class XMLsEditorInteractiveNovels : public QMainWindow
-{
-    Q_OBJECT
-
-public:
-    //Constructor
-    XMLsEditorInteractiveNovels();
-
-private slots:
-    //Funciones para los botones
-    void New();
-    void Load();
-    void Save();
-
-    void AddNode();
-    void QuitNode();
-
-private:
-    //Funciones que manejan los cambios en el xml
-    void buildTree(tinyxml2::XMLElement* rootNode, QStandardItem* parentItem);
-    void UpdateXmlNode(tinyxml2::XMLElement* xmlElement, QStandardItem* item);
-
-    //Declaraciones
-    QStandardItem* findItem(tinyxml2::XMLElement* xmlElement, QStandardItem* parent);
-    tinyxml2::XMLElement* findNode(const std::string& name, tinyxml2::XMLElement* parent);
-    Ui::XMLsEditorInteractiveNovelsClass ui;
-    QStandardItemModel* model;
-    xmlEditor::XMLEditor xmlEditorInstance;
-};
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#pragma once
+
+#include <QtWidgets/QMainWindow>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QInputDialog>
+#include <QLineEdit>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QCheckBox>
+#include <QAction>
+#include <QDockWidget>
+#include <QListWidget>
+#include <QSignalBlocker>
+#include <QElapsedTimer>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QThread>
+#include <QTimer>
+#include <QSemaphore>
+#include <QPersistentModelIndex>
+#include "ui_XMLsEditorInteractiveNovels.h"
+#include "XMLEditor.hpp"
+#include "XMLProject.hpp"
+#include "XMLTreeModel.hpp"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <chrono>
+
+class XMLsEditorInteractiveNovels : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    //Constructor
+    XMLsEditorInteractiveNovels();
+
+    //Destructor
+    ~XMLsEditorInteractiveNovels();
+
+private slots:
+    //Funciones para los botones
+    void New();
+    void Load();
+    void LoadProject();
+    void Save();
+
+    void AddNode();
+    void QuitNode();
+
+    //Lee el contenido de un capítulo diferido al desplegarlo
+    void ExpandItem(const QModelIndex& index);
+
+    //Carga en segundo plano; Cancelar para también el índice de palabras
+    void CancelLoad();
+    void FinishLoad();
+
+    //Da por construido el índice de palabras (o lo deja para la primera búsqueda si se canceló)
+    void FinishTextIndex();
+
+    //Busca el texto de la caja de búsqueda; si no ha cambiado pasa a la siguiente coincidencia.
+    //Sin coincidencias exactas muestra las parecidas.
+    void Search();
+
+    //Búsqueda aproximada mientras se escribe, con un tiempo máximo para no frenar la escritura
+    void LiveSearch();
+
+    //Filtra el árbol a las intervenciones del personaje elegido en el panel de personajes
+    void FilterCharacter();
+
+    //Vuelve a llenar el panel de personajes con sus intervenciones y palabras
+    void RefreshCharacters();
+
+    //Reemplaza en todos los documentos abiertos de una vez; se deshace también de una vez
+    void ReplaceAll();
+    void UndoReplace();
+
+private:
+    //Lee el archivo (o la carpeta del proyecto) en un hilo aparte; el documento actual sigue disponible mientras tanto
+    void StartLoad(const std::string& filePath, bool projectMode = false);
+
+    //Lee los capítulos y construye el índice de palabras en otro hilo, con el documento ya en el
+    //árbol. Los capítulos se leen en ese hilo y se ponen en su sitio en este (AttachChapter)
+    void StartTextIndex();
+    void AttachChapter(xmlEditor::XMLEditor* editor, tinyxml2::XMLElement* chapter, tinyxml2::XMLNode* content);
+
+    //Mientras se construye el índice no se cambia el documento, ni se busca ni se carga otro
+    void LockEditing(bool locked);
+
+    //Vuelve a llenar el árbol; en modo proyecto bajo una raíz común con un hijo por archivo
+    void RebuildTree();
+
+    //Documentos abiertos: los del proyecto o el archivo suelto
+    std::vector<xmlEditor::XMLEditor*> OpenDocuments();
+
+    //Documento al que pertenece un nodo
+    xmlEditor::XMLEditor* EditorFor(const tinyxml2::XMLElement* element);
+
+    //Nodos parecidos a la consulta en todos los documentos, los más cercanos primero
+    std::vector<tinyxml2::XMLElement*> FindSimilar(const std::string& query,
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+    //Muestra en el árbol la coincidencia searchPosition
+    void ShowSearchResult();
+
+    //Activa Deshacer reemplazo si algún documento tiene reemplazos que deshacer
+    void UpdateUndoReplace();
+
+    //Declaraciones
+    Ui::XMLsEditorInteractiveNovelsClass ui;
+    XMLTreeModel* model;
+    std::unique_ptr<xmlEditor::XMLEditor> xmlEditorInstance;
+
+    //Proyecto de varios archivos; si está abierto sustituye a xmlEditorInstance
+    std::unique_ptr<xmlEditor::XMLProject> project;
+
+    //Estado de la carga en segundo plano
+    QThread* loadThread;
+    std::unique_ptr<xmlEditor::XMLEditor> pendingEditor;
+    std::unique_ptr<xmlEditor::XMLProject> pendingProject;
+    std::atomic<bool> loadCancelled;
+    bool loadFailed;
+    std::string loadError;
+    QProgressBar* loadProgressBar;
+    QPushButton* cancelLoadButton;
+
+    //Estado del índice de palabras en segundo plano. El hilo espera en chapterAttached a que cada
+    //capítulo esté en su sitio; requestedChapter es un capítulo desplegado que se lee el primero y
+    //waitingChapters las filas desplegadas que esperan a su capítulo
+    QThread* indexThread;
+    std::atomic<bool> indexCancelled;
+    std::atomic<tinyxml2::XMLElement*> requestedChapter;
+    QSemaphore chapterAttached;
+    std::vector<QPersistentModelIndex> waitingChapters;
+    bool indexFailed;
+    std::string indexError;
+    QAbstractItemView::EditTriggers treeEditTriggers;
+
+    //Búsqueda de texto: nodos encontrados y el que está seleccionado
+    QLineEdit* searchBox;
+    QString lastSearch;
+    std::vector<tinyxml2::XMLElement*> searchResults;
+    std::size_t searchPosition;
+
+    //Espera a que se deje de escribir para la búsqueda aproximada; liveResults indica que los
+    //resultados son de ella y que Enter tiene que hacer la búsqueda exacta
+    QTimer* liveSearchTimer;
+    bool liveResults;
+
+    //Panel de personajes; la primera fila quita el filtro
+    QDockWidget* characterDock;
+    QListWidget* characterList;
+
+    //Junta los avisos de cambio del árbol (un reemplazo cambia muchas filas) en una sola
+    //actualización del panel de personajes
+    QTimer* characterRefreshTimer;
+
+    //Reemplazar en todo el documento y deshacerlo; cada reemplazo guarda los documentos que
+    //cambió, para deshacerlos juntos
+    QAction* replaceAction;
+    QAction* undoReplaceAction;
+    std::vector<std::vector<xmlEditor::XMLEditor*>> replaceHistory;
+};
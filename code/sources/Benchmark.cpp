@@ -0,0 +1,570 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+// Banco de pruebas: genera una novela del tamaño pedido y mide la carga, la búsqueda,
+// el guardado y la construcción del árbol. El resultado se escribe en JSON.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <QCoreApplication>
+#include "../headers/NovelGenerator.hpp"
+#include "../headers/XMLQuery.hpp"
+#include "../headers/XMLStreamReader.hpp"
+#include "../headers/XMLTreeModel.hpp"
+
+namespace
+{
+    // Reservas de memoria del proceso, contadas en operator new
+    std::atomic<std::uint64_t> allocationCount(0);
+    std::atomic<std::uint64_t> allocatedBytes(0);
+}
+
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size > 0 ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace
+{
+    struct Settings
+    {
+        xmlEditor::NovelOptions novel;
+        std::string novelPath;
+        std::string outputPath;
+        int iterations = 3;
+        bool keepFiles = false;
+        bool generate = true;
+    };
+
+    // Resultado de una medida
+    struct Measure
+    {
+        std::string name;
+        double seconds = 0.0;
+        std::uint64_t bytes = 0;
+        std::uint64_t nodes = 0;
+        std::uint64_t allocations = 0;
+        std::uint64_t allocatedBytes = 0;
+        // Crecimiento de la memoria residente durante la operación; el pico del proceso no sirve,
+        // porque lo marca la medida más grande hecha antes
+        std::int64_t residentGrowthBytes = 0;
+    };
+
+    // Repite la operación y se queda con la ejecución más rápida
+    Measure Run(const std::string& name, int iterations, const std::function<void()>& prepare,
+        const std::function<void(Measure&)>& operation)
+    {
+        Measure best;
+        best.name = name;
+        for (int i = 0; i < iterations; i++)
+        {
+            if (prepare)
+            {
+                prepare();
+            }
+            Measure current;
+            current.name = name;
+            const std::uint64_t allocationsBefore = allocationCount.load();
+            const std::uint64_t bytesBefore = allocatedBytes.load();
+            const std::size_t residentBefore = xmlEditor::XMLEditor::ResidentBytes();
+            const auto start = std::chrono::steady_clock::now();
+            operation(current);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            current.seconds = elapsed.count();
+            current.allocations = allocationCount.load() - allocationsBefore;
+            current.allocatedBytes = allocatedBytes.load() - bytesBefore;
+            current.residentGrowthBytes = static_cast<std::int64_t>(xmlEditor::XMLEditor::ResidentBytes()) - static_cast<std::int64_t>(residentBefore);
+            if (i == 0 || current.seconds < best.seconds)
+            {
+                best = current;
+            }
+        }
+        if (best.bytes > 0 && best.seconds > 0.0)
+        {
+            std::fprintf(stderr, "%-28s %10.1f ms %10.1f MB/s\n", name.c_str(), best.seconds * 1000.0, best.bytes / (1024.0 * 1024.0) / best.seconds);
+        }
+        else
+        {
+            std::fprintf(stderr, "%-28s %10.1f ms\n", name.c_str(), best.seconds * 1000.0);
+        }
+        return best;
+    }
+
+    // Filas del árbol hasta la profundidad pedida (-1 = todas), leyendo el texto de cada una
+    std::uint64_t VisitRows(XMLTreeModel& model, const QModelIndex& parent, int depth)
+    {
+        std::uint64_t count = 0;
+        // Recorrer todo el árbol es también bajar hasta el final de cada nodo: se piden todas las tandas
+        while (depth < 0 && model.canFetchMore(parent))
+        {
+            model.fetchMore(parent);
+        }
+        const int rowCount = model.rowCount(parent);
+        for (int row = 0; row < rowCount; row++)
+        {
+            const QModelIndex index = model.index(row, 0, parent);
+            model.data(index);
+            count++;
+            if (depth != 0 && model.hasChildren(index))
+            {
+                count += VisitRows(model, index, depth - 1);
+            }
+        }
+        return count;
+    }
+
+    // Nodos del documento (elementos, textos, comentarios...)
+    std::uint64_t CountNodes(const tinyxml2::XMLNode* node)
+    {
+        std::uint64_t count = 0;
+        std::vector<const tinyxml2::XMLNode*> pending(1, node);
+        while (!pending.empty())
+        {
+            const tinyxml2::XMLNode* current = pending.back();
+            pending.pop_back();
+            for (const tinyxml2::XMLNode* child = current->FirstChild(); child; child = child->NextSibling())
+            {
+                count++;
+                pending.push_back(child);
+            }
+        }
+        return count;
+    }
+
+    std::uint64_t FileSize(const std::string& path)
+    {
+        std::error_code error;
+        const std::uintmax_t size = std::filesystem::file_size(path, error);
+        return error ? 0 : static_cast<std::uint64_t>(size);
+    }
+
+    std::string JsonString(const std::string& text)
+    {
+        std::string escaped = "\"";
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped + "\"";
+    }
+
+    std::string ToJson(const Settings& settings, const xmlEditor::GeneratedNovel& novel, const std::vector<Measure>& measures)
+    {
+        std::ostringstream json;
+        json.precision(6);
+        json << "{\n";
+        json << "  \"novel\": {\n";
+        json << "    \"path\": " << JsonString(settings.novelPath) << ",\n";
+        json << "    \"bytes\": " << novel.bytes << ",\n";
+        json << "    \"chapters\": " << novel.chapters << ",\n";
+        json << "    \"elements\": " << novel.elements << ",\n";
+        json << "    \"branching\": " << settings.novel.branching << ",\n";
+        json << "    \"seed\": " << settings.novel.seed << "\n";
+        json << "  },\n";
+        json << "  \"scanKernel\": " << JsonString(tinyxml2::XMLUtil::ScanKernel()) << ",\n";
+        json << "  \"iterations\": " << settings.iterations << ",\n";
+        json << "  \"results\": [\n";
+        for (std::size_t i = 0; i < measures.size(); i++)
+        {
+            const Measure& measure = measures[i];
+            const double megabytes = measure.bytes / (1024.0 * 1024.0);
+            json << "    {\n";
+            json << "      \"name\": " << JsonString(measure.name) << ",\n";
+            json << "      \"seconds\": " << measure.seconds << ",\n";
+            json << "      \"bytes\": " << measure.bytes << ",\n";
+            json << "      \"megabytesPerSecond\": " << (measure.seconds > 0.0 ? megabytes / measure.seconds : 0.0) << ",\n";
+            json << "      \"nodes\": " << measure.nodes << ",\n";
+            json << "      \"nodesPerSecond\": " << (measure.seconds > 0.0 ? measure.nodes / measure.seconds : 0.0) << ",\n";
+            json << "      \"allocations\": " << measure.allocations << ",\n";
+            json << "      \"allocatedBytes\": " << measure.allocatedBytes << ",\n";
+            json << "      \"residentGrowthBytes\": " << measure.residentGrowthBytes << "\n";
+            json << "    }" << (i + 1 < measures.size() ? "," : "") << "\n";
+        }
+        json << "  ]\n";
+        json << "}\n";
+        return json.str();
+    }
+
+    bool ParseArguments(int argc, char* argv[], Settings& settings)
+    {
+        settings.novelPath = "benchmark_novel.xml";
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string argument = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (argument == "--size" && hasValue)
+            {
+                settings.novel.targetBytes = std::strtoull(argv[++i], nullptr, 10) * 1024 * 1024;
+            }
+            else if (argument == "--branching" && hasValue)
+            {
+                settings.novel.branching = std::atoi(argv[++i]);
+            }
+            else if (argument == "--seed" && hasValue)
+            {
+                settings.novel.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (argument == "--iterations" && hasValue)
+            {
+                settings.iterations = std::atoi(argv[++i]);
+            }
+            else if (argument == "--file" && hasValue)
+            {
+                // Usa un archivo existente en lugar de generar uno
+                settings.novelPath = argv[++i];
+                settings.generate = false;
+            }
+            else if (argument == "--output" && hasValue)
+            {
+                settings.outputPath = argv[++i];
+            }
+            else if (argument == "--keep")
+            {
+                settings.keepFiles = true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return settings.iterations > 0 && settings.novel.branching > 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Settings settings;
+    if (!ParseArguments(argc, argv, settings))
+    {
+        std::fprintf(stderr, "Usage: XMLsBenchmark [--size MB] [--branching N] [--seed N] [--iterations N]\n"
+            "                     [--file novel.xml] [--output results.json] [--keep]\n");
+        return 2;
+    }
+
+    // El modelo del árbol usa temporizadores de Qt; no hace falta ventana
+    QCoreApplication application(argc, argv);
+
+    std::vector<Measure> measures;
+    xmlEditor::GeneratedNovel novel;
+    try {
+        // Novela de prueba
+        if (settings.generate)
+        {
+            measures.push_back(Run("generate", 1, nullptr, [&](Measure& measure) {
+                novel = xmlEditor::GenerateNovel(settings.novelPath, settings.novel);
+                measure.bytes = novel.bytes;
+                measure.nodes = novel.elements;
+            }));
+        }
+        else
+        {
+            novel.bytes = FileSize(settings.novelPath);
+        }
+
+        // Un documento cargado entero para contar los nodos y para las demás medidas
+        std::unique_ptr<xmlEditor::XMLEditor> loaded = std::make_unique<xmlEditor::XMLEditor>();
+        loaded->OpenFile(settings.novelPath);
+        const std::uint64_t nodes = CountNodes(loaded->GetRootNode());
+        if (!settings.generate)
+        {
+            novel.elements = nodes;
+        }
+
+        // Lectura del archivo sin analizarlo (el límite del disco o de la caché) y lectura por
+        // eventos con XMLStreamReader, que no guarda el documento y debería acercarse a ella
+        measures.push_back(Run("readFile.raw", settings.iterations, nullptr, [&](Measure& measure) {
+            std::ifstream file(settings.novelPath, std::ios::binary);
+            std::vector<char> chunk(64 * 1024);
+            while (file.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) || file.gcount() > 0)
+            {
+                measure.bytes += static_cast<std::uint64_t>(file.gcount());
+            }
+        }));
+        measures.push_back(Run("streamReader", settings.iterations, nullptr, [&](Measure& measure) {
+            xmlEditor::XMLStreamReader reader;
+            reader.Open(settings.novelPath);
+            for (xmlEditor::StreamEvent event = reader.Next(); event != xmlEditor::StreamEvent::EndDocument; event = reader.Next())
+            {
+                if (event == xmlEditor::StreamEvent::StartElement)
+                {
+                    measure.nodes++;
+                }
+            }
+            measure.bytes = reader.BytesRead();
+        }));
+
+        // Modos de carga de XMLEditor::OpenFile
+        struct LoadMode
+        {
+            const char* name;
+            xmlEditor::LoadOptions options;
+        };
+        std::vector<LoadMode> modes(4);
+        modes[0].name = "openFile.buffered";
+        modes[1].name = "openFile.mapped";
+        modes[1].options.memoryMapped = true;
+        modes[2].name = "openFile.lazyChapters";
+        modes[2].options.memoryMapped = true;
+        modes[2].options.lazyChapters = true;
+        modes[3].name = "openFile.parallel";
+        modes[3].options.memoryMapped = true;
+        modes[3].options.parseThreads = 0;
+
+        std::unique_ptr<xmlEditor::XMLEditor> editor;
+        for (const LoadMode& mode : modes)
+        {
+            measures.push_back(Run(mode.name, settings.iterations, [&]() { editor.reset(new xmlEditor::XMLEditor()); },
+                [&](Measure& measure) {
+                editor->OpenFile(settings.novelPath, mode.options);
+                measure.bytes = novel.bytes;
+                measure.nodes = mode.options.lazyChapters ? 0 : nodes;
+            }));
+        }
+
+        // Escalado de la lectura en paralelo con el número de hilos: la parte en serie es la lectura
+        // diferida (openFile.lazyChapters), que solo busca dónde acaba cada capítulo
+        const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int threads = 1; threads <= cores; threads *= 2)
+        {
+            xmlEditor::LoadOptions options;
+            options.memoryMapped = true;
+            options.parseThreads = threads;
+            measures.push_back(Run("openFile.parallel." + std::to_string(threads), settings.iterations,
+                [&]() { editor.reset(new xmlEditor::XMLEditor()); }, [&](Measure& measure) {
+                editor->OpenFile(settings.novelPath, options);
+                measure.bytes = novel.bytes;
+                measure.nodes = nodes;
+            }));
+        }
+
+        // Escáneres de tinyxml2
+        const char* kernels[] = { "scalar", "sse2", "avx2" };
+        for (const char* kernel : kernels)
+        {
+            if (!tinyxml2::XMLUtil::SetScanKernel(kernel))
+            {
+                continue;
+            }
+            measures.push_back(Run(std::string("openFile.scan.") + kernel, settings.iterations,
+                [&]() { editor.reset(new xmlEditor::XMLEditor()); }, [&](Measure& measure) {
+                editor->OpenFile(settings.novelPath);
+                measure.bytes = novel.bytes;
+                measure.nodes = nodes;
+            }));
+        }
+        tinyxml2::XMLUtil::SetScanKernel(nullptr);
+        editor.reset();
+
+        // Búsqueda por nombre con el índice: un nombre que no existe y el primero de uno que sí
+        measures.push_back(Run("getNodeByName.miss", settings.iterations, nullptr, [&](Measure& measure) {
+            loaded->GetNodeByName("nodo_inexistente");
+            measure.nodes = nodes;
+        }));
+        measures.push_back(Run("getNodeByName.first", settings.iterations, nullptr, [&](Measure&) {
+            loaded->GetNodeByName("goto");
+        }));
+        measures.push_back(Run("getNodesByName.all", settings.iterations, nullptr, [&](Measure& measure) {
+            measure.nodes = loaded->GetNodesByName("parrafo").size();
+        }));
+
+        // Saltos entre capítulos: cada goto se resuelve con el índice de capitulo/numero
+        measures.push_back(Run("resolveGotos", settings.iterations, nullptr, [&](Measure& measure) {
+            measure.nodes = 0;
+            for (const tinyxml2::XMLElement* jump : loaded->GetNodesByName("goto"))
+            {
+                const char* target = jump->Attribute("capitulo");
+                if (target != nullptr && loaded->GetNodeByAttribute("capitulo", "numero", target) != nullptr)
+                {
+                    measure.nodes++;
+                }
+            }
+        }));
+
+        // Antes de medir las consultas se comprueba que con los índices dan lo mismo que con el
+        // recorrido: con índice de atributo, sin él (opcion/texto) y solo con el de nombres
+        for (const char* expression : { "//personaje[@nombre='Narrador']", "//opcion[@id='1']//goto",
+            "//opcion[@texto='Seguir adelante']", "/novela/capitulo[@numero<20]/parrafo/personaje" })
+        {
+            const xmlEditor::XMLQuery check(expression);
+            if (check.Run(*loaded) != check.RunTraversal(*loaded))
+            {
+                throw std::runtime_error(std::string("Query results differ between indexes and traversal: ") + expression);
+            }
+        }
+        if (loaded->HasAttributeIndex("opcion", "texto"))
+        {
+            throw std::runtime_error("A query added an attribute index");
+        }
+
+        // Consultas de rutas compiladas una vez: con los índices y con un recorrido del documento
+        const xmlEditor::XMLQuery query("//capitulo[@numero>10]//personaje[@nombre='Narrador']");
+        measures.push_back(Run("query.indexed", settings.iterations, nullptr, [&](Measure& measure) {
+            measure.nodes = query.Run(*loaded).size();
+        }));
+        measures.push_back(Run("query.traversal", settings.iterations, nullptr, [&](Measure& measure) {
+            measure.nodes = query.RunTraversal(*loaded).size();
+        }));
+
+        // Reparto de personajes y las intervenciones de uno, sin recorrer el documento
+        measures.push_back(Run("characters", settings.iterations, nullptr, [&](Measure& measure) {
+            measure.nodes = 0;
+            for (const xmlEditor::CharacterStats& character : loaded->GetCharacters())
+            {
+                measure.nodes += character.lines;
+            }
+        }));
+        measures.push_back(Run("characterLines", settings.iterations, nullptr, [&](Measure& measure) {
+            measure.nodes = loaded->GetCharacterLines("Narrador").size();
+        }));
+
+        // Índice de palabras: construcción con un hilo y con uno por núcleo, y búsquedas de frase y de prefijo
+        for (unsigned int threads : { 1u, 0u })
+        {
+            measures.push_back(Run(threads == 1 ? "buildTextIndex" : "buildTextIndex.parallel", settings.iterations,
+                [&]() { editor.reset(new xmlEditor::XMLEditor()); editor->OpenFile(settings.novelPath); }, [&](Measure& measure) {
+                editor->BuildTextIndex(threads);
+                measure.bytes = novel.bytes;
+                measure.nodes = editor->GetTextIndex().GetWordCount();
+            }));
+        }
+        editor.reset();
+        loaded->BuildTextIndex();
+        measures.push_back(Run("findText.phrase", settings.iterations, nullptr, [&](Measure& measure) {
+            measure.nodes = loaded->FindText("camino de la derecha").size();
+        }));
+        measures.push_back(Run("findText.prefix", settings.iterations, nullptr, [&](Measure& measure) {
+            measure.nodes = loaded->FindText("misterio*").size();
+        }));
+
+        // Búsqueda aproximada con faltas en las palabras y en un nombre, sin límite de tiempo y
+        // con el de un fotograma que usa la ventana mientras se escribe
+        measures.push_back(Run("findFuzzy", settings.iterations, nullptr, [&](Measure& measure) {
+            measure.nodes = loaded->FindFuzzy("camnio de la derexha").size() + loaded->FindFuzzy("Narador").size();
+        }));
+        measures.push_back(Run("findFuzzy.budget", settings.iterations, nullptr, [&](Measure& measure) {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(16);
+            measure.nodes = loaded->FindFuzzy("camnio de la derexha", 100, deadline).size();
+        }));
+
+        // Reemplazar una palabra en toda la novela con el índice de palabras ya construido, y
+        // deshacerlo; cada vuelta parte del documento original
+        const auto replaceAll = [&]() {
+            return loaded->ApplyReplacements(loaded->FindReplacements("camino", "sendero")).size();
+        };
+        measures.push_back(Run("replaceAll", settings.iterations, [&]() { while (loaded->CanUndo()) { loaded->Undo(); } },
+            [&](Measure& measure) {
+            measure.nodes = replaceAll();
+        }));
+        measures.push_back(Run("replaceAll.undo", settings.iterations, [&]() { replaceAll(); }, [&](Measure& measure) {
+            measure.nodes = loaded->Undo().size();
+        }));
+        while (loaded->CanUndo())
+        {
+            loaded->Undo();
+        }
+
+        // Guardado
+        const std::string savedPath = settings.novelPath + ".saved.xml";
+        measures.push_back(Run("saveFile", settings.iterations, nullptr, [&](Measure& measure) {
+            loaded->SaveFileAs(savedPath);
+            measure.bytes = FileSize(savedPath);
+            measure.nodes = nodes;
+        }));
+        if (!settings.keepFiles)
+        {
+            std::filesystem::remove(savedPath);
+        }
+
+        // Construcción del árbol de la ventana, con el mismo modelo que usa ella. Mostrar el
+        // documento es crear el modelo y las filas de la raíz y de sus capítulos.
+        XMLTreeModel model;
+        measures.push_back(Run("buildTree", settings.iterations, nullptr, [&](Measure& measure) {
+            model.SetDocuments({ loaded.get() });
+            measure.nodes = VisitRows(model, QModelIndex(), 2);
+        }));
+        // Todas las filas, como si se desplegara entero; Reload olvida las ya leídas
+        measures.push_back(Run("buildTree.fullWalk", settings.iterations, [&]() { model.Reload(); }, [&](Measure& measure) {
+            measure.nodes = VisitRows(model, QModelIndex(), -1);
+        }));
+        // Añade un nodo bajo la raíz y lo vuelve a quitar con el árbol ya desplegado
+        measures.push_back(Run("tree.addRemoveNode", settings.iterations, nullptr, [&](Measure& measure) {
+            const QModelIndex index = model.AddElement(loaded->GetRootNode(), "benchmark");
+            model.RemoveElement(model.ElementAt(index));
+            measure.nodes = 2;
+        }));
+    }
+    catch (std::exception& e) {
+        std::fprintf(stderr, "Benchmark failed: %s\n", e.what());
+        return 1;
+    }
+
+    if (settings.generate && !settings.keepFiles)
+    {
+        std::filesystem::remove(settings.novelPath);
+    }
+
+    const std::string json = ToJson(settings, novel, measures);
+    if (settings.outputPath.empty())
+    {
+        std::fputs(json.c_str(), stdout);
+    }
+    else
+    {
+        std::ofstream output(settings.outputPath, std::ios::out | std::ios::binary);
+        output << json;
+        if (!output)
+        {
+            std::fprintf(stderr, "Failed to write %s\n", settings.outputPath.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
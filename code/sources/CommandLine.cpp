@@ -0,0 +1,375 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+// Herramienta de línea de comandos: valida, mide, reformatea y consulta muchos
+// archivos XML a la vez sin necesidad de Qt. Solo usa XMLEditor y tinyxml2.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../headers/XMLEditor.hpp"
+#include "../headers/XMLQuery.hpp"
+#include "../headers/WorkerPool.hpp"
+
+namespace
+{
+    enum class Command
+    {
+        Validate,
+        Stats,
+        Format,
+        Query
+    };
+
+    struct Settings
+    {
+        Command command = Command::Validate;
+        unsigned int threads = 0;
+        // Consulta compilada una vez para todos los archivos
+        std::unique_ptr<xmlEditor::XMLQuery> query;
+        // Compara cada consulta hecha con los índices con la del recorrido del documento
+        bool checkQuery = false;
+        std::string outputDirectory;
+        std::vector<std::string> files;
+        // Ruta de cada archivo dentro de la carpeta de salida: la relativa a la carpeta en la que se
+        // encontró, o solo el nombre si se pasó el archivo suelto
+        std::vector<std::string> outputPaths;
+    };
+
+    // Resultado de un archivo; se escribe en el orden de la línea de comandos
+    struct FileResult
+    {
+        bool done = false;
+        bool failed = false;
+        std::string output;
+        std::string error;
+    };
+
+    // Medidas de un documento para el comando stats
+    struct DocumentStats
+    {
+        std::uint64_t chapters = 0;
+        std::uint64_t elements = 0;
+        std::uint64_t attributes = 0;
+        std::uint64_t textBytes = 0;
+        int maxDepth = 0;
+    };
+
+    DocumentStats CollectStats(const tinyxml2::XMLElement* root)
+    {
+        // Sin recursión: el cursor sigue los enlaces al padre y da la profundidad (la raíz es 1)
+        DocumentStats stats;
+        for (xmlEditor::ConstElementCursor cursor(root); cursor; cursor.Next())
+        {
+            const tinyxml2::XMLElement* element = cursor.Current();
+            const int depth = cursor.Depth() + 1;
+            stats.elements++;
+            if (depth == 2)
+            {
+                stats.chapters++;
+            }
+            stats.maxDepth = std::max(stats.maxDepth, depth);
+            for (const tinyxml2::XMLAttribute* attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+            {
+                stats.attributes++;
+            }
+            for (const tinyxml2::XMLNode* node = element->FirstChild(); node; node = node->NextSibling())
+            {
+                if (node->ToText())
+                {
+                    stats.textBytes += std::char_traits<char>::length(node->Value());
+                }
+            }
+        }
+        return stats;
+    }
+
+    std::string FormatQueryMatch(const std::string& filePath, const tinyxml2::XMLElement* element)
+    {
+        std::string line = filePath + ":" + std::to_string(element->GetLineNum()) + ": <" + element->Name();
+        for (const tinyxml2::XMLAttribute* attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+        {
+            line += std::string(" ") + attribute->Name() + "=\"" + attribute->Value() + "\"";
+        }
+        line += ">";
+        if (const char* text = element->GetText())
+        {
+            line += text;
+        }
+        return line + "\n";
+    }
+
+    // Procesa un archivo con el comando pedido
+    void ProcessFile(const Settings& settings, std::size_t fileIndex, unsigned int parseThreads, FileResult& result)
+    {
+        const std::string& filePath = settings.files[fileIndex];
+
+        // La lectura más rápida: archivo proyectado en memoria y sin capítulos diferidos
+        xmlEditor::LoadOptions options;
+        options.memoryMapped = true;
+        options.parseThreads = parseThreads;
+
+        xmlEditor::XMLEditor editor;
+        editor.OpenFile(filePath, options);
+        tinyxml2::XMLElement* root = editor.GetRootNode();
+        if (root == nullptr)
+        {
+            throw std::runtime_error("Document has no root element");
+        }
+
+        const xmlEditor::LoadStats& load = editor.GetLoadStats();
+        switch (settings.command)
+        {
+        case Command::Validate:
+            result.output = filePath + ": OK\n";
+            break;
+
+        case Command::Stats:
+        {
+            const DocumentStats stats = CollectStats(root);
+            char line[256];
+            std::snprintf(line, sizeof(line), "\t%llu\t%llu\t%llu\t%llu\t%llu\t%d\t%.3f\n",
+                static_cast<unsigned long long>(load.bytes), static_cast<unsigned long long>(stats.chapters),
+                static_cast<unsigned long long>(stats.elements), static_cast<unsigned long long>(stats.attributes),
+                static_cast<unsigned long long>(stats.textBytes), stats.maxDepth, load.seconds * 1000.0);
+            result.output = filePath + line;
+            break;
+        }
+
+        case Command::Format:
+        {
+            // Sin carpeta de salida se reescribe el propio archivo; con ella se conservan las subcarpetas
+            std::string target = filePath;
+            if (!settings.outputDirectory.empty())
+            {
+                const std::filesystem::path path = std::filesystem::path(settings.outputDirectory) / settings.outputPaths[fileIndex];
+                std::error_code error;
+                std::filesystem::create_directories(path.parent_path(), error);
+                if (error)
+                {
+                    throw std::runtime_error(error.message());
+                }
+                target = path.string();
+            }
+            editor.SaveFileAs(target);
+            result.output = filePath + " -> " + target + "\n";
+            break;
+        }
+
+        case Command::Query:
+        {
+            const std::vector<tinyxml2::XMLElement*> matches = settings.query->Run(editor);
+            if (settings.checkQuery && matches != settings.query->RunTraversal(editor))
+            {
+                throw std::runtime_error("Query results differ between indexes and traversal");
+            }
+            // Las coincidencias ya vienen en el orden del documento
+            for (const tinyxml2::XMLElement* element : matches)
+            {
+                result.output += FormatQueryMatch(filePath, element);
+            }
+            break;
+        }
+        }
+    }
+
+    // Los archivos se reparten entre los hilos y las salidas se escriben en orden
+    // en cuanto están listas las anteriores
+    bool ProcessAll(const Settings& settings)
+    {
+        std::vector<FileResult> results(settings.files.size());
+
+        // Con un solo archivo los hilos se usan para leer sus capítulos en paralelo
+        const unsigned int parseThreads = settings.files.size() == 1 ? settings.threads : 1;
+
+        std::mutex outputMutex;
+        std::size_t nextOutput = 0;
+        bool failed = false;
+
+        xmlEditor::RunParallel(settings.files.size(), settings.threads, [&](std::size_t index) {
+            FileResult result;
+            try {
+                ProcessFile(settings, index, parseThreads, result);
+            }
+            catch (const std::exception& e) {
+                result.failed = true;
+                result.output.clear();
+                result.error = settings.files[index] + ": error: " + e.what() + "\n";
+            }
+            result.done = true;
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            results[index] = std::move(result);
+            while (nextOutput < results.size() && results[nextOutput].done)
+            {
+                FileResult& ready = results[nextOutput++];
+                std::fputs(ready.output.c_str(), stdout);
+                std::fputs(ready.error.c_str(), stderr);
+                failed = failed || ready.failed;
+                ready.output.clear();
+                ready.output.shrink_to_fit();
+            }
+        });
+        std::fflush(stdout);
+        return !failed;
+    }
+
+    // Las carpetas se recorren buscando archivos .xml
+    bool AddInput(const std::string& path, std::vector<std::string>& files, std::vector<std::string>& outputPaths)
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(path, error))
+        {
+            files.push_back(path);
+            outputPaths.push_back(std::filesystem::path(path).filename().generic_string());
+            return true;
+        }
+
+        std::vector<std::string> found;
+        for (std::filesystem::recursive_directory_iterator it(path, error), end; !error && it != end; it.increment(error))
+        {
+            if (it->is_regular_file(error) && it->path().extension() == ".xml")
+            {
+                found.push_back(it->path().string());
+            }
+        }
+        if (error)
+        {
+            std::fprintf(stderr, "%s: error: %s\n", path.c_str(), error.message().c_str());
+            return false;
+        }
+        std::sort(found.begin(), found.end());
+        for (const std::string& file : found)
+        {
+            files.push_back(file);
+            outputPaths.push_back(std::filesystem::path(file).lexically_relative(path).generic_string());
+        }
+        return true;
+    }
+
+    bool ParseArguments(int argc, char* argv[], Settings& settings)
+    {
+        if (argc < 2)
+        {
+            return false;
+        }
+
+        const std::string command = argv[1];
+        int first = 2;
+        if (command == "validate")
+        {
+            settings.command = Command::Validate;
+        }
+        else if (command == "stats")
+        {
+            settings.command = Command::Stats;
+        }
+        else if (command == "format")
+        {
+            settings.command = Command::Format;
+        }
+        else if (command == "query" && argc > 2)
+        {
+            settings.command = Command::Query;
+
+            // Un nombre solo busca ese elemento en cualquier nivel, como "//nombre"
+            std::string expression = argv[2];
+            if (expression.find('/') == std::string::npos)
+            {
+                expression = "//" + expression;
+            }
+            try {
+                settings.query = std::make_unique<xmlEditor::XMLQuery>(expression);
+            }
+            catch (const std::invalid_argument& e) {
+                std::fprintf(stderr, "%s\n", e.what());
+                return false;
+            }
+            first = 3;
+        }
+        else
+        {
+            return false;
+        }
+
+        for (int i = first; i < argc; i++)
+        {
+            const std::string argument = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if ((argument == "--threads" || argument == "-j") && hasValue)
+            {
+                settings.threads = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (argument == "--output" && hasValue && settings.command == Command::Format)
+            {
+                settings.outputDirectory = argv[++i];
+            }
+            else if (argument == "--check" && settings.command == Command::Query)
+            {
+                settings.checkQuery = true;
+            }
+            else if (!argument.empty() && argument[0] == '-')
+            {
+                return false;
+            }
+            else if (!AddInput(argument, settings.files, settings.outputPaths))
+            {
+                return false;
+            }
+        }
+
+        settings.threads = xmlEditor::ResolveThreadCount(settings.threads);
+        return !settings.files.empty();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Settings settings;
+    if (!ParseArguments(argc, argv, settings))
+    {
+        std::fprintf(stderr, "Usage: XMLsCommandLine validate [-j N] <file|folder>...\n"
+            "       XMLsCommandLine stats    [-j N] <file|folder>...\n"
+            "       XMLsCommandLine format   [-j N] [--output folder] <file|folder>...\n"
+            "       XMLsCommandLine query <element|path> [-j N] [--check] <file|folder>...\n"
+            "         path: //capitulo[@numero>10]//personaje[@nombre='Narrador'], /novela/capitulo[2], ...\n");
+        return 2;
+    }
+
+    if (!settings.outputDirectory.empty())
+    {
+        std::error_code error;
+        std::filesystem::create_directories(settings.outputDirectory, error);
+        if (error)
+        {
+            std::fprintf(stderr, "%s: error: %s\n", settings.outputDirectory.c_str(), error.message().c_str());
+            return 1;
+        }
+
+        // Dos archivos con la misma ruta de salida se pisarían (y con -j a la vez)
+        std::map<std::string, std::size_t> targets;
+        for (std::size_t i = 0; i < settings.files.size(); i++)
+        {
+            const auto inserted = targets.emplace(settings.outputPaths[i], i);
+            if (!inserted.second)
+            {
+                std::fprintf(stderr, "%s, %s: error: both would be written to %s\n", settings.files[inserted.first->second].c_str(),
+                    settings.files[i].c_str(), (std::filesystem::path(settings.outputDirectory) / settings.outputPaths[i]).string().c_str());
+                return 2;
+            }
+        }
+    }
+
+    if (settings.command == Command::Stats)
+    {
+        std::printf("file\tbytes\tchapters\telements\tattributes\ttextBytes\tmaxDepth\tloadMs\n");
+    }
+    return ProcessAll(settings) ? 0 : 1;
+}
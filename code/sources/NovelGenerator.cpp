@@ -0,0 +1,195 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#include <stdexcept>
+#include <fstream>
+
+#include "../headers/NovelGenerator.hpp"
+
+namespace xmlEditor
+{
+    namespace
+    {
+        const char* const characterNames[] = {
+            "Protagonista", "Voz en la oscuridad", "Anciana del bosque", "Guardia", "Mercader",
+            "Niña perdida", "Caballero errante", "Bruja", "Narrador", "Posadero"
+        };
+
+        const char* const titleWords[] = {
+            "El comienzo", "La encrucijada", "El río", "La torre", "El regreso", "La tormenta",
+            "El puente", "La cueva", "El mercado", "La despedida", "El secreto", "La llave"
+        };
+
+        const char* const sentences[] = {
+            "Era una fría noche de invierno cuando el protagonista se adentró en el oscuro bosque.",
+            "La luna brillaba débilmente entre las ramas retorcidas de los árboles.",
+            "\"¿Quién va ahí?\", se escuchó una voz misteriosa que parecía venir desde lo más profundo del bosque.",
+            "El viento soplaba con fuerza y las hojas crujían bajo sus pies.",
+            "A lo lejos se distinguía la luz de una cabaña solitaria.",
+            "\"No deberías estar aquí a estas horas\", dijo con un tono enigmático.",
+            "El camino se dividía en dos senderos cubiertos de niebla.",
+            "Un cuervo graznó desde lo alto de una roca cubierta de musgo.",
+            "Recordó las palabras de su abuela sobre los peligros del valle.",
+            "\"Sigue el camino de la derecha si deseas encontrar la salida\", susurró la voz."
+        };
+
+        const char* const choices[] = {
+            "Responder a la voz", "Ignorar la voz y seguir caminando", "Volver sobre sus pasos",
+            "Entrar en la cabaña", "Seguir el sendero de la izquierda", "Esperar al amanecer"
+        };
+
+        // Generador xorshift: no depende de la implementación de <random>
+        class Random {
+
+        public:
+            explicit Random(std::uint32_t seed) : state(seed != 0 ? seed : 0x9E3779B9u) { }
+
+            std::uint32_t Next()
+            {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                return state;
+            }
+
+            // Entero en [low, high]
+            int Between(int low, int high)
+            {
+                return low + static_cast<int>(Next() % static_cast<std::uint32_t>(high - low + 1));
+            }
+
+            template <typename T, std::size_t N>
+            const char* Pick(T (&list)[N])
+            {
+                return list[Next() % N];
+            }
+
+        private:
+            std::uint32_t state;
+        };
+
+        // Escribe el archivo por bloques para no guardarlo entero en memoria
+        class NovelWriter {
+
+        public:
+            explicit NovelWriter(const std::string& filePath) : file(filePath, std::ios::out | std::ios::binary), bytes(0)
+            {
+                if (!file.is_open())
+                {
+                    // Lanza un aviso en caso de error al crear el archivo
+                    throw std::runtime_error("Failed to create file");
+                }
+                buffer.reserve(blockSize + 4096);
+            }
+
+            NovelWriter& operator<<(const char* text)
+            {
+                buffer += text;
+                return *this;
+            }
+
+            NovelWriter& operator<<(std::uint64_t number)
+            {
+                buffer += std::to_string(number);
+                return *this;
+            }
+
+            void FlushIfFull()
+            {
+                if (buffer.size() >= blockSize)
+                {
+                    Flush();
+                }
+            }
+
+            void Flush()
+            {
+                file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                if (!file)
+                {
+                    throw std::runtime_error("Failed to write file");
+                }
+                bytes += buffer.size();
+                buffer.clear();
+            }
+
+            std::uint64_t Written() const
+            {
+                return bytes + buffer.size();
+            }
+
+        private:
+            static const std::size_t blockSize = 1024 * 1024;
+
+            std::ofstream file;
+            std::string buffer;
+            std::uint64_t bytes;
+        };
+
+        void WriteParagraph(NovelWriter& out, Random& random, const char* indent, GeneratedNovel& result)
+        {
+            out << indent << "<parrafo>\n" << indent << "  <personaje nombre=\"" << random.Pick(characterNames) << "\">";
+            const int count = random.Between(1, 3);
+            for (int i = 0; i < count; i++)
+            {
+                out << (i > 0 ? " " : "") << random.Pick(sentences);
+            }
+            out << "</personaje>\n" << indent << "</parrafo>\n";
+            result.elements += 2;
+        }
+    }
+
+    GeneratedNovel GenerateNovel(const std::string& filePath, const NovelOptions& options)
+    {
+        if (options.branching < 1)
+        {
+            throw std::invalid_argument("Branching must be at least 1");
+        }
+
+        NovelWriter out(filePath);
+        Random random(options.seed);
+        GeneratedNovel result;
+
+        out << "<novela>\n";
+        result.elements = 1;
+        while (result.chapters == 0 || out.Written() < options.targetBytes)
+        {
+            const std::uint64_t number = ++result.chapters;
+            out << "  <capitulo numero=\"" << number << "\" titulo=\"" << random.Pick(titleWords) << "\">\n";
+            result.elements++;
+
+            // Párrafos narrativos
+            const int paragraphs = random.Between(2, 6);
+            for (int i = 0; i < paragraphs; i++)
+            {
+                WriteParagraph(out, random, "    ", result);
+            }
+
+            // Decisión con sus opciones; cada una lleva a un capítulo posterior
+            out << "    <parrafo>\n";
+            result.elements++;
+            for (int option = 1; option <= options.branching; option++)
+            {
+                out << "      <opcion id=\"" << static_cast<std::uint64_t>(option) << "\" texto=\"" << random.Pick(choices) << "\">\n";
+                out << "        <accion>\n";
+                const int consequences = random.Between(1, 2);
+                for (int i = 0; i < consequences; i++)
+                {
+                    WriteParagraph(out, random, "          ", result);
+                }
+                out << "          <goto capitulo=\"" << number + static_cast<std::uint64_t>(random.Between(1, 5)) << "\" />\n";
+                out << "        </accion>\n";
+                out << "      </opcion>\n";
+                result.elements += 3;
+            }
+            out << "    </parrafo>\n";
+            out << "  </capitulo>\n  \n";
+            out.FlushIfFull();
+        }
+        out << "</novela>\n";
+        out.Flush();
+
+        result.bytes = out.Written();
+        return result;
+    }
+}
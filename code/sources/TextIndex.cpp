@@ -0,0 +1,727 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <unordered_set>
+
+#include "../headers/TextIndex.hpp"
+#include "../headers/ElementCursor.hpp"
+#include "../headers/WorkerPool.hpp"
+
+namespace xmlEditor
+{
+    namespace
+    {
+        // Letras de C3 80 a C3 BF (Latin-1 en UTF-8) sin tilde y en minúscula.
+        // '*' = se deja la letra en minúscula (ñ, ç...), ' ' = no es una letra (× y ÷)
+        const char LatinLetters[] = "aaaaaa*ceeeeiiii**ooooo *uuuuy**aaaaaa*ceeeeiiii**ooooo *uuuuy*y";
+
+        // Llama a onWord con cada palabra del texto; word es el buffer en el que se forman
+        template <typename Callback>
+        void ReadWords(const char* text, std::string& word, Callback&& onWord)
+        {
+            word.clear();
+            const unsigned char* c = reinterpret_cast<const unsigned char*>(text);
+            while (true)
+            {
+                const unsigned char byte = *c;
+                bool separator = false;
+                if (byte == 0)
+                {
+                    if (!word.empty())
+                    {
+                        onWord(word);
+                    }
+                    return;
+                }
+                if (byte < 0x80)
+                {
+                    if ((byte >= '0' && byte <= '9') || (byte >= 'a' && byte <= 'z'))
+                    {
+                        word.push_back(static_cast<char>(byte));
+                    }
+                    else if (byte >= 'A' && byte <= 'Z')
+                    {
+                        word.push_back(static_cast<char>(byte + ('a' - 'A')));
+                    }
+                    else
+                    {
+                        separator = true;
+                    }
+                    c++;
+                }
+                else if (byte == 0xC3 && c[1] >= 0x80 && c[1] <= 0xBF)
+                {
+                    const char letter = LatinLetters[c[1] - 0x80];
+                    if (letter == ' ')
+                    {
+                        separator = true;
+                    }
+                    else if (letter == '*')
+                    {
+                        word.push_back('\xC3');
+                        word.push_back(static_cast<char>(c[1] < 0x9F ? c[1] + 0x20 : c[1]));
+                    }
+                    else
+                    {
+                        word.push_back(letter);
+                    }
+                    c += 2;
+                }
+                else if (byte == 0xC2 && c[1] != 0)
+                {
+                    // Signos de Latin-1: ¡ ¿ « » y el espacio duro
+                    separator = true;
+                    c += 2;
+                }
+                else if (byte == 0xE2 && c[1] == 0x80 && c[2] != 0)
+                {
+                    // Puntuación general: rayas, comillas tipográficas, puntos suspensivos
+                    separator = true;
+                    c += 3;
+                }
+                else
+                {
+                    // Letras de otros alfabetos, tal cual
+                    word.push_back(static_cast<char>(byte));
+                    c++;
+                }
+                if (separator && !word.empty())
+                {
+                    onWord(word);
+                    word.clear();
+                }
+            }
+        }
+
+        // Palabras de un tramo de elementos con un vocabulario propio, para leerlo en otro hilo.
+        // Cada elemento con texto va con su posición en la lista.
+        struct LocalWords
+        {
+            std::unordered_map<std::string, std::uint32_t> terms;
+            std::vector<std::string> termNames;
+            std::vector<std::tuple<tinyxml2::XMLElement*, std::size_t, std::vector<std::uint32_t>>> entries;
+        };
+
+        void ReadElements(const std::vector<tinyxml2::XMLElement*>& elements, std::size_t first, std::size_t last, LocalWords& local)
+        {
+            std::string word;
+            std::vector<std::uint32_t> sequence;
+            for (std::size_t i = first; i < last; i++)
+            {
+                sequence.clear();
+                for (const tinyxml2::XMLNode* child = elements[i]->FirstChild(); child != nullptr; child = child->NextSibling())
+                {
+                    const tinyxml2::XMLText* text = child->ToText();
+                    if (text == nullptr)
+                    {
+                        continue;
+                    }
+                    ReadWords(text->Value(), word, [&](const std::string& found) {
+                        const auto inserted = local.terms.emplace(found, static_cast<std::uint32_t>(local.termNames.size()));
+                        if (inserted.second)
+                        {
+                            local.termNames.push_back(found);
+                        }
+                        sequence.push_back(inserted.first->second);
+                    });
+                }
+                if (!sequence.empty())
+                {
+                    local.entries.emplace_back(elements[i], i, sequence);
+                }
+            }
+        }
+
+        // Elemento anterior y siguiente en el orden del documento
+        const tinyxml2::XMLElement* PreviousInDocument(const tinyxml2::XMLElement* element)
+        {
+            if (const tinyxml2::XMLElement* previous = element->PreviousSiblingElement())
+            {
+                while (previous->LastChildElement() != nullptr)
+                {
+                    previous = previous->LastChildElement();
+                }
+                return previous;
+            }
+            return element->Parent() ? element->Parent()->ToElement() : nullptr;
+        }
+
+        const tinyxml2::XMLElement* NextInDocument(const tinyxml2::XMLElement* element)
+        {
+            if (const tinyxml2::XMLElement* child = element->FirstChildElement())
+            {
+                return child;
+            }
+            for (; element != nullptr; element = element->Parent() ? element->Parent()->ToElement() : nullptr)
+            {
+                if (const tinyxml2::XMLElement* next = element->NextSiblingElement())
+                {
+                    return next;
+                }
+            }
+            return nullptr;
+        }
+
+        // Hueco entre las posiciones de dos elementos seguidos al construir el índice
+        const std::uint64_t OrderSpacing = std::uint64_t(1) << 32;
+        const std::uint64_t NoOrder = std::numeric_limits<std::uint64_t>::max();
+    }
+
+    TextIndex::TextIndex() { }
+
+    TextIndex::~TextIndex() { }
+
+    void TextIndex::Clear()
+    {
+        terms.clear();
+        termNames.clear();
+        termTrigrams.Clear();
+        postings.clear();
+        entries.clear();
+        wordCount = 0;
+        sortedTerms.clear();
+    }
+
+    void TextIndex::Add(const std::vector<tinyxml2::XMLElement*>& elements, unsigned int threads)
+    {
+        if (elements.empty())
+        {
+            return;
+        }
+
+        // Un elemento que ya estaba se vuelve a leer entero
+        std::vector<tinyxml2::XMLElement*> indexed;
+        for (tinyxml2::XMLElement* element : elements)
+        {
+            if (entries.count(element) != 0)
+            {
+                indexed.push_back(element);
+            }
+        }
+        Remove(indexed);
+
+        // Los elementos se reparten el hueco entre sus vecinos del índice; al final del documento
+        // se sigue con el hueco normal. Si no caben se reparten antes todas las posiciones.
+        Order before = OrderBefore(elements.front());
+        Order after = OrderAfter(elements.back());
+        Order step = OrderSpacing;
+        if (after != NoOrder)
+        {
+            step = (after - before) / (elements.size() + 1);
+            if (step == 0)
+            {
+                Renumber(elements.front()->GetDocument()->RootElement());
+                before = OrderBefore(elements.front());
+                after = OrderAfter(elements.back());
+                step = after == NoOrder ? OrderSpacing : (after - before) / (elements.size() + 1);
+            }
+        }
+        std::vector<Order> orders(elements.size());
+        for (std::size_t i = 0; i < elements.size(); i++)
+        {
+            orders[i] = before + step * (i + 1);
+        }
+        Insert(elements, orders, threads);
+    }
+
+    void TextIndex::Update(const std::vector<tinyxml2::XMLElement*>& elements, unsigned int threads)
+    {
+        // Los que ya estaban, por su posición, para que sus nuevas apariciones entren en orden
+        std::vector<std::pair<Order, tinyxml2::XMLElement*>> indexed;
+        std::vector<tinyxml2::XMLElement*> added;
+        for (tinyxml2::XMLElement* element : elements)
+        {
+            const auto found = entries.find(element);
+            if (found != entries.end())
+            {
+                indexed.push_back({ found->second.order, element });
+            }
+            else
+            {
+                added.push_back(element);
+            }
+        }
+        std::sort(indexed.begin(), indexed.end());
+        indexed.erase(std::unique(indexed.begin(), indexed.end()), indexed.end());
+        std::vector<tinyxml2::XMLElement*> kept;
+        std::vector<Order> orders;
+        kept.reserve(indexed.size());
+        orders.reserve(indexed.size());
+        for (const auto& element : indexed)
+        {
+            orders.push_back(element.first);
+            kept.push_back(element.second);
+        }
+        Remove(kept);
+        Insert(kept, orders, threads);
+
+        // Los que no tenían palabras no tienen posición: se colocan uno a uno entre sus vecinos
+        for (tinyxml2::XMLElement* element : added)
+        {
+            Add({ element });
+        }
+    }
+
+    void TextIndex::Insert(const std::vector<tinyxml2::XMLElement*>& elements, const std::vector<Order>& orders, unsigned int threads)
+    {
+        if (elements.empty())
+        {
+            return;
+        }
+
+        // Cada hilo lee un tramo con su vocabulario; los tramos se juntan después en orden.
+        // Con pocos elementos no compensa repartirlos.
+        const std::size_t minimumPerChunk = 4096;
+        std::size_t chunks = std::min<std::size_t>(ResolveThreadCount(threads) * 4, elements.size() / minimumPerChunk);
+        chunks = std::max<std::size_t>(chunks, 1);
+        std::vector<LocalWords> locals(chunks);
+        RunParallel(chunks, threads, [&](std::size_t chunk) {
+            ReadElements(elements, elements.size() * chunk / chunks, elements.size() * (chunk + 1) / chunks, locals[chunk]);
+        });
+
+        // Largo de cada lista antes de añadir: si lo nuevo va en medio se mezcla con lo que había
+        const std::size_t untouched = std::numeric_limits<std::size_t>::max();
+        std::vector<std::size_t> previousSizes;
+        std::vector<TermId> touched;
+        std::vector<TermId> distinct;
+        for (LocalWords& local : locals)
+        {
+            std::vector<TermId> global(local.termNames.size());
+            for (std::size_t i = 0; i < local.termNames.size(); i++)
+            {
+                global[i] = TermFor(local.termNames[i]);
+            }
+            previousSizes.resize(termNames.size(), untouched);
+            for (auto& entry : local.entries)
+            {
+                tinyxml2::XMLElement* element = std::get<0>(entry);
+                const Order order = orders[std::get<1>(entry)];
+                std::vector<TermId>& sequence = std::get<2>(entry);
+                for (TermId& term : sequence)
+                {
+                    term = global[term];
+                }
+
+                // Cada elemento aparece una vez en la lista de cada palabra
+                distinct.assign(sequence.begin(), sequence.end());
+                std::sort(distinct.begin(), distinct.end());
+                distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+                for (TermId term : distinct)
+                {
+                    if (previousSizes[term] == untouched)
+                    {
+                        previousSizes[term] = postings[term].size();
+                        touched.push_back(term);
+                    }
+                    postings[term].push_back({ order, element });
+                }
+                wordCount += sequence.size();
+                entries[element] = { order, std::move(sequence) };
+            }
+        }
+        const auto byOrder = [](const Posting& a, const Posting& b) {
+            return a.order < b.order;
+        };
+        for (TermId term : touched)
+        {
+            std::vector<Posting>& nodes = postings[term];
+            const auto added = nodes.begin() + static_cast<std::ptrdiff_t>(previousSizes[term]);
+            if (added != nodes.begin() && added->order < (added - 1)->order)
+            {
+                std::inplace_merge(nodes.begin(), added, nodes.end(), byOrder);
+            }
+        }
+    }
+
+    void TextIndex::Remove(const std::vector<tinyxml2::XMLElement*>& elements)
+    {
+        // Posiciones que salen de la lista de cada palabra
+        std::unordered_map<TermId, std::vector<Order>> removed;
+        std::vector<TermId> distinct;
+        for (const tinyxml2::XMLElement* element : elements)
+        {
+            const auto found = entries.find(element);
+            if (found == entries.end())
+            {
+                continue;
+            }
+            const std::vector<TermId>& sequence = found->second.words;
+            distinct.assign(sequence.begin(), sequence.end());
+            std::sort(distinct.begin(), distinct.end());
+            distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+            for (TermId term : distinct)
+            {
+                removed[term].push_back(found->second.order);
+            }
+            wordCount -= sequence.size();
+            entries.erase(found);
+        }
+
+        // Las listas de las palabras comunes son largas: con pocos elementos se buscan uno a uno,
+        // con muchos (un capítulo borrado) la lista se recorre una sola vez
+        const std::size_t searchLimit = 8;
+        for (auto& term : removed)
+        {
+            std::vector<Posting>& nodes = postings[term.first];
+            std::vector<Order>& gone = term.second;
+            if (gone.size() <= searchLimit)
+            {
+                for (Order order : gone)
+                {
+                    const auto position = std::lower_bound(nodes.begin(), nodes.end(), order, [](const Posting& posting, Order value) {
+                        return posting.order < value;
+                    });
+                    if (position != nodes.end() && position->order == order)
+                    {
+                        nodes.erase(position);
+                    }
+                }
+                continue;
+            }
+            std::sort(gone.begin(), gone.end());
+            nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [&](const Posting& posting) {
+                return std::binary_search(gone.begin(), gone.end(), posting.order);
+            }), nodes.end());
+        }
+    }
+
+    std::vector<tinyxml2::XMLElement*> TextIndex::Find(const std::string& query) const
+    {
+        // Cada palabra de la consulta con las del vocabulario que le valen, ordenadas
+        std::vector<std::vector<TermId>> phrase;
+        std::size_t start = 0;
+        while (start < query.size())
+        {
+            const std::size_t space = query.find_first_of(" \t\r\n", start);
+            const std::size_t end = space == std::string::npos ? query.size() : space;
+            std::string piece = query.substr(start, end - start);
+            start = end + 1;
+
+            const bool prefix = !piece.empty() && piece.back() == '*';
+            piece.erase(piece.find_last_not_of('*') + 1);
+            const std::vector<std::string> pieceWords = Tokenize(piece.c_str());
+            for (std::size_t i = 0; i < pieceWords.size(); i++)
+            {
+                std::vector<TermId> matching;
+                if (prefix && i + 1 == pieceWords.size())
+                {
+                    matching = TermsWithPrefix(pieceWords[i]);
+                    std::sort(matching.begin(), matching.end());
+                }
+                else
+                {
+                    const auto found = terms.find(pieceWords[i]);
+                    if (found != terms.end())
+                    {
+                        matching.push_back(found->second);
+                    }
+                }
+                if (matching.empty())
+                {
+                    return {};
+                }
+                phrase.push_back(std::move(matching));
+            }
+        }
+        if (phrase.empty())
+        {
+            return {};
+        }
+
+        // Los candidatos salen de la palabra con menos apariciones
+        std::size_t rarest = 0;
+        std::size_t rarestCount = std::numeric_limits<std::size_t>::max();
+        for (std::size_t i = 0; i < phrase.size(); i++)
+        {
+            std::size_t count = 0;
+            for (TermId term : phrase[i])
+            {
+                count += postings[term].size();
+            }
+            if (count < rarestCount)
+            {
+                rarest = i;
+                rarestCount = count;
+            }
+        }
+        std::vector<Posting> candidates;
+        candidates.reserve(rarestCount);
+        for (TermId term : phrase[rarest])
+        {
+            candidates.insert(candidates.end(), postings[term].begin(), postings[term].end());
+        }
+        if (phrase[rarest].size() > 1)
+        {
+            // Las listas de un prefijo se juntan en orden; un elemento puede estar en varias
+            std::sort(candidates.begin(), candidates.end(), [](const Posting& a, const Posting& b) {
+                return a.order < b.order;
+            });
+            candidates.erase(std::unique(candidates.begin(), candidates.end(), [](const Posting& a, const Posting& b) {
+                return a.order == b.order;
+            }), candidates.end());
+        }
+
+        // Las frases se comprueban con las palabras de cada candidato
+        const auto matches = [](TermId term, const std::vector<TermId>& matching) {
+            return matching.size() == 1 ? term == matching.front() : std::binary_search(matching.begin(), matching.end(), term);
+        };
+        std::vector<tinyxml2::XMLElement*> results;
+        results.reserve(phrase.size() == 1 ? candidates.size() : 0);
+        for (const Posting& candidate : candidates)
+        {
+            if (phrase.size() == 1)
+            {
+                results.push_back(candidate.element);
+                continue;
+            }
+            const std::vector<TermId>& sequence = entries.at(candidate.element).words;
+            for (std::size_t position = 0; position + phrase.size() <= sequence.size(); position++)
+            {
+                std::size_t length = 0;
+                while (length < phrase.size() && matches(sequence[position + length], phrase[length]))
+                {
+                    length++;
+                }
+                if (length == phrase.size())
+                {
+                    results.push_back(candidate.element);
+                    break;
+                }
+            }
+        }
+        return results;
+    }
+
+    std::vector<FuzzyMatch> TextIndex::FindFuzzy(const std::string& query, std::size_t maxResults,
+        std::chrono::steady_clock::time_point deadline) const
+    {
+        const std::vector<std::string> words = Tokenize(query.c_str());
+        if (words.empty() || maxResults == 0)
+        {
+            return {};
+        }
+
+        // Palabras del vocabulario parecidas a cada una de la consulta, de la más cercana a la más lejana
+        std::vector<std::vector<TrigramIndex::Match>> similar(words.size());
+        std::vector<std::unordered_map<TermId, int>> distances(words.size());
+        std::size_t rarest = 0;
+        std::size_t rarestCount = std::numeric_limits<std::size_t>::max();
+        int worstDistance = 0;
+        for (std::size_t i = 0; i < words.size(); i++)
+        {
+            const int maxDistance = TrigramIndex::MaxDistanceFor(words[i].size());
+            similar[i] = termTrigrams.Find(words[i], maxDistance);
+            worstDistance += maxDistance;
+            std::size_t count = 0;
+            for (const TrigramIndex::Match& match : similar[i])
+            {
+                if (!postings[match.id].empty())
+                {
+                    count += postings[match.id].size();
+                    distances[i].emplace(match.id, match.distance);
+                }
+            }
+            if (count == 0)
+            {
+                return {};
+            }
+            if (count < rarestCount)
+            {
+                rarest = i;
+                rarestCount = count;
+            }
+        }
+
+        // Los candidatos salen de la palabra con menos apariciones; con varias palabras se
+        // comprueban las demás con las del candidato
+        struct Ranked
+        {
+            int distance;
+            Order order;
+            tinyxml2::XMLElement* element;
+        };
+        std::vector<Ranked> ranked;
+        std::vector<std::size_t> rankedPerDistance(static_cast<std::size_t>(worstDistance) + 1, 0);
+        std::unordered_set<const tinyxml2::XMLElement*> seen;
+        std::size_t checked = 0;
+        bool timedOut = false;
+        for (const TrigramIndex::Match& term : similar[rarest])
+        {
+            // Los elementos de esta palabra no bajan de su distancia: si ya hay bastantes más
+            // cercanos no pueden entrar
+            const std::size_t closer = std::accumulate(rankedPerDistance.begin(), rankedPerDistance.begin() + term.distance, std::size_t(0));
+            if (closer >= maxResults || timedOut)
+            {
+                break;
+            }
+            std::size_t added = 0;
+            for (const Posting& posting : postings[term.id])
+            {
+                if ((++checked & 255) == 0 && std::chrono::steady_clock::now() >= deadline)
+                {
+                    timedOut = true;
+                    break;
+                }
+                if (!seen.insert(posting.element).second)
+                {
+                    continue;
+                }
+                int total = term.distance;
+                if (words.size() > 1)
+                {
+                    total = 0;
+                    const std::vector<TermId>& sequence = entries.at(posting.element).words;
+                    for (std::size_t i = 0; i < words.size() && total >= 0; i++)
+                    {
+                        int best = -1;
+                        for (TermId word : sequence)
+                        {
+                            const auto found = distances[i].find(word);
+                            if (found != distances[i].end() && (best < 0 || found->second < best))
+                            {
+                                best = found->second;
+                            }
+                        }
+                        total = best < 0 ? -1 : total + best;
+                    }
+                    if (total < 0)
+                    {
+                        continue;
+                    }
+                }
+                ranked.push_back({ total, posting.order, posting.element });
+                rankedPerDistance[total]++;
+
+                // Ninguno baja de la distancia de esta palabra y los siguientes van después en el
+                // documento: con bastantes en esa distancia ya no pueden entrar
+                if (total == term.distance && ++added == maxResults)
+                {
+                    break;
+                }
+            }
+        }
+
+        const std::size_t count = std::min(maxResults, ranked.size());
+        std::partial_sort(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(count), ranked.end(), [](const Ranked& a, const Ranked& b) {
+            return a.distance != b.distance ? a.distance < b.distance : a.order < b.order;
+        });
+        std::vector<FuzzyMatch> results;
+        results.reserve(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            results.push_back({ ranked[i].element, ranked[i].distance });
+        }
+        return results;
+    }
+
+    std::vector<std::string> TextIndex::Tokenize(const char* text)
+    {
+        std::vector<std::string> found;
+        std::string word;
+        ReadWords(text, word, [&](const std::string& next) {
+            found.push_back(next);
+        });
+        return found;
+    }
+
+    std::size_t TextIndex::GetElementCount() const
+    {
+        return entries.size();
+    }
+
+    std::size_t TextIndex::GetWordCount() const
+    {
+        return wordCount;
+    }
+
+    TextIndex::TermId TextIndex::TermFor(const std::string& word)
+    {
+        const auto inserted = terms.emplace(word, static_cast<TermId>(termNames.size()));
+        if (inserted.second)
+        {
+            termNames.push_back(word);
+            termTrigrams.Add(inserted.first->second, word);
+            postings.emplace_back();
+        }
+        return inserted.first->second;
+    }
+
+    TextIndex::Order TextIndex::OrderBefore(const tinyxml2::XMLElement* element) const
+    {
+        for (const tinyxml2::XMLElement* previous = PreviousInDocument(element); previous != nullptr; previous = PreviousInDocument(previous))
+        {
+            const auto found = entries.find(previous);
+            if (found != entries.end())
+            {
+                return found->second.order;
+            }
+        }
+        return 0;
+    }
+
+    TextIndex::Order TextIndex::OrderAfter(const tinyxml2::XMLElement* element) const
+    {
+        for (const tinyxml2::XMLElement* next = NextInDocument(element); next != nullptr; next = NextInDocument(next))
+        {
+            const auto found = entries.find(next);
+            if (found != entries.end())
+            {
+                return found->second.order;
+            }
+        }
+        return NoOrder;
+    }
+
+    void TextIndex::Renumber(tinyxml2::XMLElement* root)
+    {
+        // El orden relativo no cambia, así que las listas siguen ordenadas
+        Order order = 0;
+        for (ConstElementCursor cursor(root); cursor; cursor.Next())
+        {
+            const tinyxml2::XMLElement* element = cursor.Current();
+            const auto found = entries.find(element);
+            if (found != entries.end())
+            {
+                order += OrderSpacing;
+                found->second.order = order;
+            }
+        }
+        for (std::vector<Posting>& nodes : postings)
+        {
+            for (Posting& posting : nodes)
+            {
+                posting.order = entries.at(posting.element).order;
+            }
+        }
+    }
+
+    std::vector<TextIndex::TermId> TextIndex::TermsWithPrefix(const std::string& prefix) const
+    {
+        // Las palabras no se quitan del vocabulario, solo se añaden: si hay nuevas se vuelve a ordenar
+        if (sortedTerms.size() != termNames.size())
+        {
+            sortedTerms.resize(termNames.size());
+            std::iota(sortedTerms.begin(), sortedTerms.end(), 0);
+            std::sort(sortedTerms.begin(), sortedTerms.end(), [this](TermId a, TermId b) {
+                return termNames[a] < termNames[b];
+            });
+        }
+
+        std::vector<TermId> matching;
+        auto term = std::lower_bound(sortedTerms.begin(), sortedTerms.end(), prefix, [this](TermId id, const std::string& value) {
+            return termNames[id] < value;
+        });
+        for (; term != sortedTerms.end() && termNames[*term].compare(0, prefix.size(), prefix) == 0; ++term)
+        {
+            if (!postings[*term].empty())
+            {
+                matching.push_back(*term);
+            }
+        }
+        return matching;
+    }
+}
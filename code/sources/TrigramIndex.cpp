@@ -0,0 +1,169 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#include <algorithm>
+#include <numeric>
+
+#include "../headers/TrigramIndex.hpp"
+
+namespace xmlEditor
+{
+    void TrigramIndex::Clear()
+    {
+        lists.clear();
+        words.clear();
+        wordCount = 0;
+    }
+
+    void TrigramIndex::Add(std::uint32_t id, const std::string& word)
+    {
+        // Las palabras vacías no se guardan: no hay nada que buscar en ellas
+        if (word.empty())
+        {
+            return;
+        }
+        if (id >= words.size())
+        {
+            words.resize(static_cast<std::size_t>(id) + 1);
+        }
+        words[id] = word;
+        wordCount++;
+
+        std::vector<Trigram> trigrams;
+        Split(word, trigrams);
+        std::sort(trigrams.begin(), trigrams.end());
+        trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+        for (Trigram trigram : trigrams)
+        {
+            lists[trigram].push_back(id);
+        }
+    }
+
+    std::vector<TrigramIndex::Match> TrigramIndex::Find(const std::string& word, int maxDistance) const
+    {
+        std::vector<Match> found;
+        if (word.empty() || maxDistance < 0)
+        {
+            return found;
+        }
+        const auto check = [&](std::uint32_t id) {
+            const std::string& candidate = words[id];
+            const std::size_t difference = candidate.size() > word.size() ? candidate.size() - word.size() : word.size() - candidate.size();
+            if (candidate.empty() || difference > static_cast<std::size_t>(maxDistance))
+            {
+                return;
+            }
+            const int distance = EditDistance(word, candidate, maxDistance);
+            if (distance <= maxDistance)
+            {
+                found.push_back({ id, distance });
+            }
+        };
+
+        // Trigramas que una palabra a distancia maxDistance comparte como mínimo con la buscada.
+        // Si un trigrama se repite en la buscada se cuenta cada vez: el filtro deja pasar alguna
+        // palabra de más, pero nunca quita una que valga.
+        std::vector<Trigram> trigrams;
+        Split(word, trigrams);
+        const int required = static_cast<int>(trigrams.size()) - 3 * maxDistance;
+        if (required <= 0)
+        {
+            // Con una palabra tan corta el filtro no descarta nada: se miran todas
+            for (std::uint32_t id = 0; id < words.size(); id++)
+            {
+                check(id);
+            }
+        }
+        else
+        {
+            std::vector<std::uint32_t> shared(words.size(), 0);
+            std::vector<std::uint32_t> candidates;
+            for (Trigram trigram : trigrams)
+            {
+                const auto list = lists.find(trigram);
+                if (list == lists.end())
+                {
+                    continue;
+                }
+                for (std::uint32_t id : list->second)
+                {
+                    if (++shared[id] == static_cast<std::uint32_t>(required))
+                    {
+                        candidates.push_back(id);
+                    }
+                }
+            }
+            for (std::uint32_t id : candidates)
+            {
+                check(id);
+            }
+        }
+        std::sort(found.begin(), found.end(), [](const Match& a, const Match& b) {
+            return a.distance != b.distance ? a.distance < b.distance : a.id < b.id;
+        });
+        return found;
+    }
+
+    const std::string& TrigramIndex::GetWord(std::uint32_t id) const
+    {
+        return words.at(id);
+    }
+
+    std::size_t TrigramIndex::GetWordCount() const
+    {
+        return wordCount;
+    }
+
+    int TrigramIndex::MaxDistanceFor(std::size_t length)
+    {
+        if (length <= 2)
+        {
+            return 0;
+        }
+        return length <= 5 ? 1 : 2;
+    }
+
+    int TrigramIndex::EditDistance(const std::string& a, const std::string& b, int limit)
+    {
+        const std::size_t difference = a.size() > b.size() ? a.size() - b.size() : b.size() - a.size();
+        if (difference > static_cast<std::size_t>(limit))
+        {
+            return limit + 1;
+        }
+
+        // Una sola fila de la tabla; se deja de calcular cuando toda la fila pasa del límite
+        std::vector<int> row(b.size() + 1);
+        std::iota(row.begin(), row.end(), 0);
+        for (std::size_t i = 1; i <= a.size(); i++)
+        {
+            int diagonal = row[0];
+            row[0] = static_cast<int>(i);
+            int best = row[0];
+            for (std::size_t j = 1; j <= b.size(); j++)
+            {
+                const int above = row[j];
+                row[j] = std::min({ above + 1, row[j - 1] + 1, diagonal + (a[i - 1] != b[j - 1] ? 1 : 0) });
+                diagonal = above;
+                best = std::min(best, row[j]);
+            }
+            if (best > limit)
+            {
+                return limit + 1;
+            }
+        }
+        return std::min(row[b.size()], limit + 1);
+    }
+
+    void TrigramIndex::Split(const std::string& word, std::vector<Trigram>& trigrams)
+    {
+        // Los huecos son el byte 0, que no aparece en las palabras
+        trigrams.clear();
+        const auto byteAt = [&](std::size_t position) -> Trigram {
+            return position >= 2 && position - 2 < word.size() ? static_cast<unsigned char>(word[position - 2]) : 0;
+        };
+        for (std::size_t i = 0; i < word.size() + 2; i++)
+        {
+            trigrams.push_back((byteAt(i) << 16) | (byteAt(i + 1) << 8) | byteAt(i + 2));
+        }
+    }
+}
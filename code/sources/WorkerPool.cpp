@@ -0,0 +1,70 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../headers/WorkerPool.hpp"
+
+namespace xmlEditor
+{
+    unsigned int ResolveThreadCount(unsigned int threads)
+    {
+        if (threads > 0)
+        {
+            return threads;
+        }
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    void RunParallel(std::size_t count, unsigned int threads, const std::function<void(std::size_t)>& task)
+    {
+        const std::size_t threadCount = std::min<std::size_t>(ResolveThreadCount(threads), count);
+        std::atomic<std::size_t> next(0);
+        std::atomic<bool> stop(false);
+        std::mutex errorMutex;
+        std::exception_ptr firstError;
+
+        auto worker = [&]() {
+            while (!stop)
+            {
+                const std::size_t index = next.fetch_add(1);
+                if (index >= count)
+                {
+                    return;
+                }
+                try {
+                    task(index);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!firstError)
+                    {
+                        firstError = std::current_exception();
+                    }
+                    stop = true;
+                }
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (std::size_t i = 1; i < threadCount; i++)
+        {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : pool)
+        {
+            thread.join();
+        }
+
+        if (firstError)
+        {
+            std::rethrow_exception(firstError);
+        }
+    }
+}
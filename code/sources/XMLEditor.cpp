@@ -1,139 +1,1409 @@
-// Autor: felixhmy 
-// Todos los derechos reservados © 2025 
-
-#include <stdexcept>
-#include <fstream>
-
-#include "../headers/XMLEditor.hpp"
-
-namespace xmlEditor
-{
-    XMLEditor::XMLEditor() { }
-
-    XMLEditor::~XMLEditor() { }
-
-    void XMLEditor::OpenFile(const std::string& filePath)
-    {
-        tinyxml2::XMLError eResult = xmlDoc.LoadFile(filePath.c_str());
-        if (eResult != tinyxml2::XML_SUCCESS)
-        {
-            // Lanza un aviso en caso de error al abrir el archivo
-            throw std::runtime_error("Failed to load file");
-        }
-    }
-
-    tinyxml2::XMLElement* XMLEditor::GetRootNode()
-    {
-        return xmlDoc.RootElement();
-    }
-
-    tinyxml2::XMLElement* XMLEditor::GetChildNode(tinyxml2::XMLElement* parentNode, const std::string& nodeName)
-    {
-        if (parentNode == nullptr)
-        {
-            // Lanza un aviso en caso de que de error
-            throw std::invalid_argument("Parent node is null");
-        }
-        return parentNode->FirstChildElement(nodeName.c_str());
-    }
-
-    tinyxml2::XMLElement* XMLEditor::AddChildNode(tinyxml2::XMLElement* parentNode, const std::string& nodeName)
-    {
-        if (parentNode == nullptr)
-        {
-            // Lanza un aviso en caso de que de error
-            throw std::invalid_argument("Parent node is null");
-        }
-        tinyxml2::XMLElement* newChild = xmlDoc.NewElement(nodeName.c_str());
-        parentNode->InsertEndChild(newChild);
-        return newChild;
-    }
-
-    void XMLEditor::RemoveChildNode(tinyxml2::XMLElement* parentNode, tinyxml2::XMLElement* childNode)
-    {
-        if (parentNode == nullptr || childNode == nullptr)
-        {
-            // Lanza un aviso en caso de que de error
-            throw std::invalid_argument("Parent node or child node is null");
-        }
-        parentNode->DeleteChild(childNode);
-    }
-
-    void XMLEditor::ModifyNodeValue(tinyxml2::XMLElement* node, const std::string& newValue)
-    {
-        if (node) // verifica que el nodo exista
-        {
-            node->SetText(newValue.c_str());
-        }
-    }
-
-    void XMLEditor::ModifyNodeAttribute(tinyxml2::XMLElement* node, const std::string& attributeName, const std::string& attributeValue)
-    {
-        if (node) // verifica que el nodo exista
-        {
-            node->SetAttribute(attributeName.c_str(), attributeValue.c_str());
-        }
-    }
-
-    void XMLEditor::SaveFile(const std::string& filePath)
-    {
-        tinyxml2::XMLError eResult = xmlDoc.SaveFile(filePath.c_str());
-        if (eResult != tinyxml2::XML_SUCCESS)
-        {
-            // Lanza un aviso en caso de error al guardar el archivo
-            throw std::runtime_error("Failed to save file");
-        }
-    }
-    void XMLEditor::SaveFileAs(const std::string& newFilePath)
-    {
-        tinyxml2::XMLError eResult = xmlDoc.SaveFile(newFilePath.c_str());
-        if (eResult != tinyxml2::XML_SUCCESS)
-        {
-            // Lanza un aviso en caso de error al guardar el archivo
-            throw std::runtime_error("Failed to save file");
-        }
-    }
-
-
-    void XMLEditor::CreateNew(const std::string& rootName)
-    {
-        // Limpiar el documento actual
-        xmlDoc.Clear();
-
-        // Crear la declaración XML
-        tinyxml2::XMLDeclaration* decl = xmlDoc.NewDeclaration();
-        xmlDoc.InsertFirstChild(decl);
-
-        // Crear el nodo raíz
-        tinyxml2::XMLElement* root = xmlDoc.NewElement(rootName.c_str());
-        xmlDoc.InsertEndChild(root);
-    }
-
-    tinyxml2::XMLElement* XMLEditor::GetNodeByName(const std::string& nodeName)
-    {
-        return GetNodeByNameRecursive(xmlDoc.RootElement(), nodeName);
-    }
-
-    tinyxml2::XMLElement* XMLEditor::GetNodeByNameRecursive(tinyxml2::XMLElement* startNode, const std::string& nodeName)
-    {
-        // Primero, comprueba si el nodo actual tiene el nombre correcto
-        if (startNode->Name() == nodeName)
-        {
-            return startNode;
-        }
-
-        // A continuación, busca en todos los nodos hijos del nodo actual
-        for (tinyxml2::XMLElement* childNode = startNode->FirstChildElement(); childNode != nullptr; childNode = childNode->NextSiblingElement())
-        {
-            tinyxml2::XMLElement* result = GetNodeByNameRecursive(childNode, nodeName);
-            if (result != nullptr)
-            {
-                return result;
-            }
-        }
-
-        // Si no se encontró el nodo, devuelve nullptr
-        return nullptr;
-    }
-
-}
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#include <stdexcept>
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <system_error>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <regex>
+#include <unordered_set>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+#endif
+
+#include "../headers/XMLEditor.hpp"
+#include "../headers/WorkerPool.hpp"
+
+namespace xmlEditor
+{
+    namespace
+    {
+        // Pasa el avance del parser de tinyxml2 a la función de LoadOptions
+        class ProgressMonitor : public tinyxml2::XMLParseMonitor {
+
+        public:
+            explicit ProgressMonitor(const LoadOptions& options) : options(options) { }
+
+            bool Progress(size_t parsedBytes, size_t totalBytes) override
+            {
+                return options.progress(parsedBytes, totalBytes);
+            }
+
+        private:
+            const LoadOptions& options;
+        };
+
+        // Palabras de un texto, separadas por espacios
+        std::size_t CountWords(const char* text)
+        {
+            std::size_t count = 0;
+            bool inWord = false;
+            for (; text != nullptr && *text != 0; ++text)
+            {
+                const bool space = *text == ' ' || *text == '\t' || *text == '\n' || *text == '\r';
+                if (!space && !inWord)
+                {
+                    count++;
+                }
+                inWord = !space;
+            }
+            return count;
+        }
+
+        // Letras ASCII en minúscula, para buscar texto literal sin distinguir mayúsculas
+        void FoldCase(std::string& text)
+        {
+            for (char& c : text)
+            {
+                if (c >= 'A' && c <= 'Z')
+                {
+                    c = static_cast<char>(c - 'A' + 'a');
+                }
+            }
+        }
+
+        // Hijo de texto número position de un nodo, contando solo los textos (como el índice de palabras)
+        tinyxml2::XMLText* TextChild(tinyxml2::XMLElement* element, std::size_t position)
+        {
+            for (tinyxml2::XMLNode* child = element->FirstChild(); child != nullptr; child = child->NextSibling())
+            {
+                tinyxml2::XMLText* text = child->ToText();
+                if (text != nullptr && position-- == 0)
+                {
+                    return text;
+                }
+            }
+            return nullptr;
+        }
+
+        // Un nombre o título como se compara en la búsqueda aproximada: sus palabras en minúsculas
+        // y sin tildes, separadas por un espacio
+        std::string NormalizeValue(const char* value)
+        {
+            std::string normalized;
+            for (const std::string& word : TextIndex::Tokenize(value))
+            {
+                if (!normalized.empty())
+                {
+                    normalized.push_back(' ');
+                }
+                normalized += word;
+            }
+            return normalized;
+        }
+    }
+
+    XMLEditor::XMLEditor()
+    {
+        // Pares que se usan para seguir los saltos entre capítulos y las opciones
+        AddAttributeIndex("capitulo", "numero");
+        AddAttributeIndex("chapter", "number");
+        AddAttributeIndex("opcion", "id");
+
+        // Reparto de personajes, con las palabras de cada uno
+        AddAttributeIndex("personaje", "nombre");
+        attributeIndexes.back().countWords = true;
+        attributeIndexes.back().fuzzy = true;
+
+        // Títulos de los capítulos, para encontrarlos sin escribirlos exactos
+        AddAttributeIndex("capitulo", "titulo");
+        attributeIndexes.back().fuzzy = true;
+    }
+
+    XMLEditor::~XMLEditor() { }
+
+    void XMLEditor::OpenFile(const std::string& filePath, const LoadOptions& options)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        // Los índices apuntan a los elementos del documento anterior
+        nameIndex.clear();
+        for (AttributeIndex& index : attributeIndexes)
+        {
+            index.nodes.clear();
+            index.words.clear();
+            index.valueTrigramsReady = false;
+        }
+        pendingChapters = false;
+        textIndex.Clear();
+        textIndexReady = false;
+        chapterWorkspace = nullptr;
+        undoHistory.clear();
+
+        ProgressMonitor monitor(options);
+        xmlDoc.SetDeferredParsing(options.lazyChapters);
+        const unsigned int threads = options.parseThreads > 0 ? options.parseThreads : std::thread::hardware_concurrency();
+        xmlDoc.SetParseThreads(static_cast<int>(threads));
+        xmlDoc.SetParseMonitor(options.progress ? &monitor : nullptr);
+        tinyxml2::XMLError eResult = options.memoryMapped
+            ? xmlDoc.LoadFileMapped(filePath.c_str())
+            : xmlDoc.LoadFile(filePath.c_str());
+        xmlDoc.SetParseMonitor(nullptr);
+        if (eResult == tinyxml2::XML_ERROR_PARSING_CANCELLED)
+        {
+            // Carga cancelada por quien la pidió: no se deja un documento a medias
+            xmlDoc.Clear();
+            throw std::runtime_error("File loading cancelled");
+        }
+        if (eResult != tinyxml2::XML_SUCCESS)
+        {
+            // Lanza un aviso en caso de error al abrir el archivo, con la línea y el motivo
+            throw std::runtime_error(std::string("Failed to load file: ") + xmlDoc.ErrorStr());
+        }
+
+        // Índice de nombres de lo ya leído; los capítulos diferidos se añaden al leerlos
+        BuildNameIndex();
+        pendingChapters = options.lazyChapters;
+
+        // Guarda las medidas de la carga
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::error_code error;
+        const std::uintmax_t fileSize = std::filesystem::file_size(filePath, error);
+
+        loadedFilePath = filePath;
+        currentFilePath = filePath;
+        modifiedNodes.clear();
+        loadStats.memoryMapped = xmlDoc.IsMapped();
+        loadStats.bytes = error ? 0 : static_cast<std::size_t>(fileSize);
+        loadStats.seconds = elapsed.count();
+        loadStats.megabytesPerSecond = loadStats.seconds > 0.0 ? (loadStats.bytes / (1024.0 * 1024.0)) / loadStats.seconds : 0.0;
+        loadStats.peakResidentBytes = PeakResidentBytes();
+    }
+
+    const LoadStats& XMLEditor::GetLoadStats() const
+    {
+        return loadStats;
+    }
+
+    std::size_t XMLEditor::PeakResidentBytes()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            return counters.PeakWorkingSetSize;
+        }
+        return 0;
+#else
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+        {
+            return 0;
+        }
+#if defined(__APPLE__)
+        return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+        // En Linux ru_maxrss viene en kilobytes
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+    }
+
+    std::size_t XMLEditor::ResidentBytes()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            return counters.WorkingSetSize;
+        }
+        return 0;
+#elif defined(__APPLE__)
+        mach_task_basic_info_data_t info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+        {
+            return 0;
+        }
+        return static_cast<std::size_t>(info.resident_size);
+#else
+        // El segundo campo de statm son las páginas residentes
+        std::ifstream statm("/proc/self/statm");
+        std::size_t size = 0;
+        std::size_t resident = 0;
+        if (!(statm >> size >> resident))
+        {
+            return 0;
+        }
+        return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    tinyxml2::XMLElement* XMLEditor::GetRootNode()
+    {
+        return xmlDoc.RootElement();
+    }
+
+    void XMLEditor::ExpandNode(tinyxml2::XMLElement* node)
+    {
+        if (node == nullptr || !node->IsDeferred())
+        {
+            return;
+        }
+        if (xmlDoc.ExpandDeferred(node) != tinyxml2::XML_SUCCESS)
+        {
+            // Lanza un aviso en caso de error al leer el contenido del capítulo
+            throw std::runtime_error("Failed to parse node content");
+        }
+        const std::vector<tinyxml2::XMLElement*> elements = SubtreeElements(node, true);
+        IndexElements(std::vector<tinyxml2::XMLElement*>(elements.begin() + 1, elements.end()));
+        if (textIndexReady)
+        {
+            // El capítulo ya estaba en el índice de palabras, pero sin su texto
+            textIndex.Add(elements);
+        }
+    }
+
+    bool XMLEditor::IsDeferred(const tinyxml2::XMLElement* node) const
+    {
+        return node != nullptr && node->IsDeferred();
+    }
+
+    bool XMLEditor::Contains(const tinyxml2::XMLNode* node) const
+    {
+        return node != nullptr && node->GetDocument() == &xmlDoc;
+    }
+
+    tinyxml2::XMLElement* XMLEditor::GetChildNode(tinyxml2::XMLElement* parentNode, const std::string& nodeName)
+    {
+        if (parentNode == nullptr)
+        {
+            // Lanza un aviso en caso de que de error
+            throw std::invalid_argument("Parent node is null");
+        }
+        ExpandNode(parentNode);
+        return parentNode->FirstChildElement(nodeName.c_str());
+    }
+
+    tinyxml2::XMLElement* XMLEditor::AddChildNode(tinyxml2::XMLElement* parentNode, const std::string& nodeName)
+    {
+        if (parentNode == nullptr)
+        {
+            // Lanza un aviso en caso de que de error
+            throw std::invalid_argument("Parent node is null");
+        }
+        ExpandNode(parentNode);
+        tinyxml2::XMLElement* newChild = xmlDoc.NewElement(nodeName.c_str());
+        parentNode->InsertEndChild(newChild);
+        IndexElements({ newChild });
+        MarkModified(parentNode);
+        MarkModified(newChild);
+        return newChild;
+    }
+
+    void XMLEditor::RemoveChildNode(tinyxml2::XMLElement* parentNode, tinyxml2::XMLElement* childNode)
+    {
+        if (parentNode == nullptr || childNode == nullptr)
+        {
+            // Lanza un aviso en caso de que de error
+            throw std::invalid_argument("Parent node or child node is null");
+        }
+        ForgetModified(childNode);
+        undoHistory.clear();
+        const std::vector<tinyxml2::XMLElement*> elements = SubtreeElements(childNode, true);
+        UnindexElements(elements);
+        if (textIndexReady)
+        {
+            textIndex.Remove(elements);
+        }
+        parentNode->DeleteChild(childNode);
+        MarkModified(parentNode);
+    }
+
+    void XMLEditor::RenameNode(tinyxml2::XMLElement* node, const std::string& newName)
+    {
+        if (node) // verifica que el nodo exista
+        {
+            // Un capítulo sin leer se lee antes: su etiqueta de cierre tiene que coincidir con el nombre
+            ExpandNode(node);
+            UnindexElements({ node });
+            node->SetName(newName.c_str());
+            IndexElements({ node });
+            MarkModified(node);
+        }
+    }
+
+    void XMLEditor::ModifyNodeValue(tinyxml2::XMLElement* node, const std::string& newValue)
+    {
+        if (node) // verifica que el nodo exista
+        {
+            ExpandNode(node);
+            undoHistory.clear();
+            if (textIndexReady)
+            {
+                textIndex.Remove({ node });
+            }
+            CountIndexedWords(node, false);
+            node->SetText(newValue.c_str());
+            CountIndexedWords(node, true);
+            if (textIndexReady)
+            {
+                textIndex.Add({ node });
+            }
+            MarkModified(node);
+        }
+    }
+
+    void XMLEditor::ModifyNodeAttribute(tinyxml2::XMLElement* node, const std::string& attributeName, const std::string& attributeValue)
+    {
+        if (node) // verifica que el nodo exista
+        {
+            undoHistory.clear();
+
+            // El nodo pasa de la lista de su valor anterior a la del nuevo
+            AttributeIndex* index = FindAttributeIndex(node->Name(), attributeName);
+            if (index != nullptr)
+            {
+                UnindexAttribute(*index, node, node->Attribute(attributeName.c_str()));
+            }
+            node->SetAttribute(attributeName.c_str(), attributeValue.c_str());
+            if (index != nullptr)
+            {
+                IndexAttribute(*index, node, node->Attribute(attributeName.c_str()));
+            }
+            MarkModified(node);
+        }
+    }
+
+    void XMLEditor::SaveFile(const std::string& filePath)
+    {
+        PrepareSaveTarget(filePath);
+        tinyxml2::XMLError eResult = xmlDoc.SaveFile(filePath.c_str());
+        if (eResult != tinyxml2::XML_SUCCESS)
+        {
+            // Lanza un aviso en caso de error al guardar el archivo
+            throw std::runtime_error("Failed to save file");
+        }
+
+        // El archivo ya coincide con el documento
+        currentFilePath = filePath;
+        modifiedNodes.clear();
+    }
+    void XMLEditor::SaveFileAs(const std::string& newFilePath)
+    {
+        PrepareSaveTarget(newFilePath);
+        tinyxml2::XMLError eResult = xmlDoc.SaveFile(newFilePath.c_str());
+        if (eResult != tinyxml2::XML_SUCCESS)
+        {
+            // Lanza un aviso en caso de error al guardar el archivo
+            throw std::runtime_error("Failed to save file");
+        }
+
+        // El archivo ya coincide con el documento
+        currentFilePath = newFilePath;
+        modifiedNodes.clear();
+    }
+
+    void XMLEditor::PrepareSaveTarget(const std::string& filePath)
+    {
+        // Los capítulos diferidos se leen antes de abrir el archivo de destino
+        try {
+            ExpandAllNodes();
+        }
+        catch (std::runtime_error&) {
+            throw std::runtime_error("Failed to save file");
+        }
+
+        // Los textos del documento apuntan a la proyección del archivo original;
+        // antes de sobrescribirlo se copian a memoria propia
+        if (!xmlDoc.IsMapped())
+        {
+            return;
+        }
+        std::error_code error;
+        if (std::filesystem::equivalent(filePath, loadedFilePath, error) && !error)
+        {
+            xmlDoc.ReleaseMapping();
+        }
+    }
+
+    bool XMLEditor::IsModified() const
+    {
+        return !modifiedNodes.empty();
+    }
+
+    const std::unordered_set<const tinyxml2::XMLElement*>& XMLEditor::GetModifiedNodes() const
+    {
+        return modifiedNodes;
+    }
+
+    const std::string& XMLEditor::GetFilePath() const
+    {
+        return currentFilePath;
+    }
+
+    void XMLEditor::MarkModified(const tinyxml2::XMLElement* node)
+    {
+        modifiedNodes.insert(node);
+    }
+
+    void XMLEditor::ForgetModified(const tinyxml2::XMLElement* node)
+    {
+        // Un nodo borrado puede dejar su dirección a otro nuevo; no debe seguir en la lista
+        if (modifiedNodes.empty())
+        {
+            return;
+        }
+        for (ConstElementCursor cursor(node); cursor; cursor.Next())
+        {
+            modifiedNodes.erase(cursor.Current());
+        }
+    }
+
+    void XMLEditor::CreateNew(const std::string& rootName)
+    {
+        // Limpiar el documento actual
+        xmlDoc.Clear();
+        loadedFilePath.clear();
+        currentFilePath.clear();
+        modifiedNodes.clear();
+        textIndex.Clear();
+        textIndexReady = false;
+        chapterWorkspace = nullptr;
+        undoHistory.clear();
+
+        // Crear la declaración XML
+        tinyxml2::XMLDeclaration* decl = xmlDoc.NewDeclaration();
+        xmlDoc.InsertFirstChild(decl);
+
+        // Crear el nodo raíz
+        tinyxml2::XMLElement* root = xmlDoc.NewElement(rootName.c_str());
+        xmlDoc.InsertEndChild(root);
+        BuildNameIndex();
+        pendingChapters = false;
+
+        // Un documento nuevo aún no está en ningún archivo
+        MarkModified(root);
+    }
+
+    tinyxml2::XMLElement* XMLEditor::GetNodeByName(const std::string& nodeName)
+    {
+        const std::vector<tinyxml2::XMLElement*>& nodes = GetNodesByName(nodeName);
+        return nodes.empty() ? nullptr : nodes.front();
+    }
+
+    tinyxml2::XMLElement* XMLEditor::GetNodeByNameRecursive(tinyxml2::XMLElement* startNode, const std::string& nodeName)
+    {
+        if (startNode == nullptr)
+        {
+            // Lanza un aviso en caso de que de error
+            throw std::invalid_argument("Start node is null");
+        }
+
+        // Solo hace falta leer los capítulos pendientes que estén dentro de startNode
+        if (startNode == xmlDoc.RootElement())
+        {
+            ExpandAllNodes();
+        }
+        else
+        {
+            ExpandNode(startNode);
+        }
+        const auto found = nameIndex.find(nodeName);
+        if (found == nameIndex.end())
+        {
+            return nullptr;
+        }
+
+        // Los nodos de un subárbol van seguidos: el primero que no va antes de startNode
+        // es el resultado si está dentro de startNode
+        const std::vector<tinyxml2::XMLElement*>& nodes = found->second;
+        const auto candidate = std::lower_bound(nodes.begin(), nodes.end(), startNode, IsBefore);
+        if (candidate == nodes.end())
+        {
+            return nullptr;
+        }
+        for (const tinyxml2::XMLNode* ancestor = *candidate; ancestor != nullptr; ancestor = ancestor->Parent())
+        {
+            if (ancestor == startNode)
+            {
+                return *candidate;
+            }
+        }
+        return nullptr;
+    }
+
+    const std::vector<tinyxml2::XMLElement*>& XMLEditor::GetNodesByName(const std::string& nodeName)
+    {
+        static const std::vector<tinyxml2::XMLElement*> noNodes;
+        ExpandAllNodes();
+        const auto found = nameIndex.find(nodeName);
+        return found == nameIndex.end() ? noNodes : found->second;
+    }
+
+    void XMLEditor::ExpandAllNodes()
+    {
+        if (!pendingChapters)
+        {
+            return;
+        }
+        if (xmlDoc.ExpandAllDeferred() != tinyxml2::XML_SUCCESS)
+        {
+            // Lanza un aviso en caso de error al leer el contenido de los capítulos
+            throw std::runtime_error("Failed to parse node content");
+        }
+
+        // Con muchos capítulos nuevos es más barato rehacer el índice que insertar en él
+        BuildNameIndex();
+        pendingChapters = false;
+
+        if (textIndexReady)
+        {
+            textIndexReady = false;
+            BuildTextIndex(textIndexThreads);
+        }
+    }
+
+    std::vector<tinyxml2::XMLElement*> XMLEditor::FindText(const std::string& query)
+    {
+        ExpandAllNodes();
+        BuildTextIndex(textIndexThreads);
+        return textIndex.Find(query);
+    }
+
+    std::vector<FuzzyMatch> XMLEditor::FindFuzzy(const std::string& query, std::size_t maxResults, std::chrono::steady_clock::time_point deadline)
+    {
+        ExpandAllNodes();
+        BuildTextIndex(textIndexThreads);
+
+        // Nombres y títulos parecidos a la consulta entera, con sus nodos en el orden del documento.
+        // Los valores salen de más cercano a más lejano, así que basta con los primeros de cada par.
+        std::vector<FuzzyMatch> named;
+        const std::string normalized = NormalizeValue(query.c_str());
+        const int maxDistance = TrigramIndex::MaxDistanceFor(normalized.size());
+        for (AttributeIndex& index : attributeIndexes)
+        {
+            if (!index.fuzzy)
+            {
+                continue;
+            }
+            BuildValueTrigrams(index);
+            const std::size_t first = named.size();
+            for (const TrigramIndex::Match& match : index.valueTrigrams.Find(normalized, maxDistance))
+            {
+                for (tinyxml2::XMLElement* node : index.nodes.at(index.fuzzyValues[match.id]))
+                {
+                    if (named.size() - first == maxResults)
+                    {
+                        break;
+                    }
+                    named.push_back({ node, match.distance });
+                }
+            }
+        }
+        std::stable_sort(named.begin(), named.end(), [](const FuzzyMatch& a, const FuzzyMatch& b) {
+            return a.distance < b.distance;
+        });
+
+        // Se juntan con los del texto por distancia; un nodo encontrado por las dos vías sale una vez
+        const std::vector<FuzzyMatch> found = textIndex.FindFuzzy(query, maxResults, deadline);
+        std::vector<FuzzyMatch> results;
+        std::unordered_set<const tinyxml2::XMLElement*> seen;
+        std::size_t nextNamed = 0;
+        std::size_t nextFound = 0;
+        while (results.size() < maxResults && (nextNamed < named.size() || nextFound < found.size()))
+        {
+            const bool takeNamed = nextFound == found.size() || (nextNamed < named.size() && named[nextNamed].distance <= found[nextFound].distance);
+            const FuzzyMatch& next = takeNamed ? named[nextNamed++] : found[nextFound++];
+            if (seen.insert(next.element).second)
+            {
+                results.push_back(next);
+            }
+        }
+        return results;
+    }
+
+    std::vector<Replacement> XMLEditor::FindReplacements(const std::string& pattern, const std::string& replacement, const ReplaceOptions& options)
+    {
+        if (pattern.empty())
+        {
+            throw std::invalid_argument("Search pattern is empty");
+        }
+        ExpandAllNodes();
+
+        // El texto literal se busca con strstr; sin distinguir mayúsculas, en una copia del valor y
+        // del texto buscado con las letras en minúscula
+        std::regex expression;
+        std::string needle = pattern;
+        if (!options.matchCase)
+        {
+            FoldCase(needle);
+        }
+        if (options.regex)
+        {
+            const std::regex::flag_type flags = options.matchCase ? std::regex::ECMAScript : std::regex::ECMAScript | std::regex::icase;
+            try {
+                expression = std::regex(pattern, flags);
+            }
+            catch (const std::regex_error& e) {
+                throw std::invalid_argument(std::string("Invalid regular expression: ") + e.what());
+            }
+        }
+
+        // Valor nuevo si la búsqueda cambia algo
+        const auto replaceIn = [&](const char* value, std::string& result, std::string& folded) {
+            if (options.regex)
+            {
+                if (!std::regex_search(value, expression))
+                {
+                    return false;
+                }
+                result = std::regex_replace(std::string(value), expression, replacement);
+                return result != value;
+            }
+            const char* haystack = value;
+            if (!options.matchCase)
+            {
+                folded.assign(value);
+                FoldCase(folded);
+                haystack = folded.c_str();
+            }
+            const char* found = std::strstr(haystack, needle.c_str());
+            if (found == nullptr)
+            {
+                return false;
+            }
+            result.clear();
+            std::size_t position = 0;
+            for (; found != nullptr; found = std::strstr(haystack + position, needle.c_str()))
+            {
+                const std::size_t offset = static_cast<std::size_t>(found - haystack);
+                result.append(value + position, offset - position);
+                result += replacement;
+                position = offset + needle.size();
+            }
+            result += value + position;
+            return result != value;
+        };
+
+        // Cada hilo busca en un tramo seguido de nodos; los tramos se juntan en orden
+        tinyxml2::XMLElement* root = xmlDoc.RootElement();
+        const std::vector<tinyxml2::XMLElement*> elements = root ? SubtreeElements(root, true) : std::vector<tinyxml2::XMLElement*>();
+        const std::size_t minimumPerChunk = 1024;
+        std::size_t chunks = std::min<std::size_t>(ResolveThreadCount(options.threads) * 4, elements.size() / minimumPerChunk);
+        chunks = std::max<std::size_t>(chunks, 1);
+        std::vector<std::vector<Replacement>> found(chunks);
+        RunParallel(chunks, options.threads, [&](std::size_t chunk) {
+            std::string result;
+            std::string folded;
+            for (std::size_t i = elements.size() * chunk / chunks; i < elements.size() * (chunk + 1) / chunks; i++)
+            {
+                tinyxml2::XMLElement* element = elements[i];
+                // Todos los textos del nodo, también los que van entre hijos, como en el índice de palabras
+                std::size_t position = 0;
+                for (const tinyxml2::XMLNode* child = element->FirstChild(); options.text && child != nullptr; child = child->NextSibling())
+                {
+                    const tinyxml2::XMLText* text = child->ToText();
+                    if (text == nullptr)
+                    {
+                        continue;
+                    }
+                    if (replaceIn(text->Value(), result, folded))
+                    {
+                        found[chunk].push_back({ element, std::string(), text->Value(), result, position });
+                    }
+                    position++;
+                }
+                for (const tinyxml2::XMLAttribute* attribute = element->FirstAttribute(); options.attributes && attribute != nullptr; attribute = attribute->Next())
+                {
+                    if (replaceIn(attribute->Value(), result, folded))
+                    {
+                        found[chunk].push_back({ element, attribute->Name(), attribute->Value(), result, 0 });
+                    }
+                }
+            }
+        });
+
+        std::vector<Replacement> changes;
+        for (std::vector<Replacement>& chunk : found)
+        {
+            changes.insert(changes.end(), std::make_move_iterator(chunk.begin()), std::make_move_iterator(chunk.end()));
+        }
+        return changes;
+    }
+
+    std::vector<Replacement> XMLEditor::ApplyReplacements(const std::vector<Replacement>& changes)
+    {
+        // Los cambios pueden ser de antes de borrar nodos o de abrir otro archivo: solo se leen los
+        // nodos que siguen en el árbol, sin tocar los punteros que ya no son de él
+        std::unordered_set<const tinyxml2::XMLElement*> live;
+        if (!changes.empty() && xmlDoc.RootElement() != nullptr)
+        {
+            const std::vector<tinyxml2::XMLElement*> elements = SubtreeElements(xmlDoc.RootElement(), true);
+            live.insert(elements.begin(), elements.end());
+        }
+
+        std::vector<Replacement> applied;
+        for (const Replacement& change : changes)
+        {
+            if (live.count(change.node) == 0)
+            {
+                continue;
+            }
+            const tinyxml2::XMLText* text = change.attribute.empty() ? TextChild(change.node, change.textPosition) : nullptr;
+            const char* current = change.attribute.empty() ? (text ? text->Value() : nullptr) : change.node->Attribute(change.attribute.c_str());
+            // Dos cambios del mismo valor (de dos búsquedas distintas) no se pueden aplicar los dos
+            bool repeated = false;
+            for (auto previous = applied.rbegin(); previous != applied.rend() && previous->node == change.node; ++previous)
+            {
+                repeated = repeated || (previous->attribute == change.attribute && previous->textPosition == change.textPosition);
+            }
+            if (current != nullptr && change.before == current && !repeated)
+            {
+                applied.push_back(change);
+            }
+        }
+        if (applied.empty())
+        {
+            return applied;
+        }
+        WriteReplacements(applied);
+        undoHistory.push_back(applied);
+        return applied;
+    }
+
+    bool XMLEditor::CanUndo() const
+    {
+        return !undoHistory.empty();
+    }
+
+    std::vector<Replacement> XMLEditor::Undo()
+    {
+        if (undoHistory.empty())
+        {
+            return {};
+        }
+        std::vector<Replacement> changes = std::move(undoHistory.back());
+        undoHistory.pop_back();
+        for (Replacement& change : changes)
+        {
+            std::swap(change.before, change.after);
+        }
+        WriteReplacements(changes);
+        return changes;
+    }
+
+    void XMLEditor::WriteReplacements(const std::vector<Replacement>& changes)
+    {
+        // Atributos: los nodos salen de las listas de sus valores anteriores y entran en las de los
+        // nuevos de una vez por índice. Al renombrar un personaje son todas sus intervenciones.
+        std::unordered_map<AttributeIndex*, std::vector<tinyxml2::XMLElement*>> moved;
+        for (const Replacement& change : changes)
+        {
+            if (change.attribute.empty())
+            {
+                continue;
+            }
+            if (AttributeIndex* index = FindAttributeIndex(change.node->Name(), change.attribute))
+            {
+                moved[index].push_back(change.node);
+            }
+        }
+        for (auto& entry : moved)
+        {
+            UnindexAttributes(*entry.first, entry.second);
+        }
+        for (const Replacement& change : changes)
+        {
+            if (!change.attribute.empty())
+            {
+                change.node->SetAttribute(change.attribute.c_str(), change.after.c_str());
+                MarkModified(change.node);
+            }
+        }
+        for (auto& entry : moved)
+        {
+            IndexAttributes(*entry.first, entry.second);
+        }
+
+        // Textos: el índice de palabras se corrige una vez para todos
+        std::vector<tinyxml2::XMLElement*> changedText;
+        for (const Replacement& change : changes)
+        {
+            if (change.attribute.empty())
+            {
+                CountIndexedWords(change.node, false);
+                TextChild(change.node, change.textPosition)->SetValue(change.after.c_str());
+                CountIndexedWords(change.node, true);
+                MarkModified(change.node);
+                // Los cambios de un mismo nodo van seguidos; el nodo se vuelve a leer una vez
+                if (changedText.empty() || changedText.back() != change.node)
+                {
+                    changedText.push_back(change.node);
+                }
+            }
+        }
+        if (textIndexReady)
+        {
+            textIndex.Update(changedText, textIndexThreads);
+        }
+    }
+
+    void XMLEditor::BuildTextIndex(unsigned int threads)
+    {
+        if (textIndexReady)
+        {
+            return;
+        }
+        tinyxml2::XMLElement* root = xmlDoc.RootElement();
+        textIndex.Clear();
+        if (root != nullptr)
+        {
+            textIndex.Add(SubtreeElements(root, true), threads);
+        }
+        for (AttributeIndex& index : attributeIndexes)
+        {
+            BuildValueTrigrams(index);
+        }
+        textIndexReady = true;
+        textIndexThreads = threads;
+    }
+
+    const TextIndex& XMLEditor::GetTextIndex() const
+    {
+        return textIndex;
+    }
+
+    std::vector<tinyxml2::XMLElement*> XMLEditor::BeginTextIndex()
+    {
+        std::vector<tinyxml2::XMLElement*> chapters;
+        textIndex.Clear();
+        textIndexReady = false;
+        tinyxml2::XMLElement* root = xmlDoc.RootElement();
+        if (root == nullptr)
+        {
+            return chapters;
+        }
+        if (chapterWorkspace == nullptr)
+        {
+            chapterWorkspace = xmlDoc.NewWorkspace();
+        }
+
+        // Los capítulos van detrás del nodo raíz, así que cada uno se añade al final del índice
+        textIndex.Add({ root });
+        for (tinyxml2::XMLElement* chapter = root->FirstChildElement(); chapter != nullptr; chapter = chapter->NextSiblingElement())
+        {
+            chapters.push_back(chapter);
+        }
+        return chapters;
+    }
+
+    tinyxml2::XMLNode* XMLEditor::ReadChapter(const tinyxml2::XMLElement* chapter) const
+    {
+        tinyxml2::XMLNode* content = nullptr;
+        if (xmlDoc.ParseDeferredContent(chapter, chapterWorkspace, &content) != tinyxml2::XML_SUCCESS)
+        {
+            // Lanza un aviso en caso de error al leer el contenido del capítulo
+            throw std::runtime_error(std::string("Failed to parse node content: ") + chapterWorkspace->ErrorStr());
+        }
+        return content;
+    }
+
+    void XMLEditor::AttachChapter(tinyxml2::XMLElement* chapter, tinyxml2::XMLNode* content)
+    {
+        if (!chapter->IsDeferred())
+        {
+            return;
+        }
+        xmlDoc.AttachDeferredContent(chapter, content);
+        IndexElements(SubtreeElements(chapter, false));
+    }
+
+    void XMLEditor::IndexChapterText(tinyxml2::XMLElement* chapter)
+    {
+        textIndex.Add(SubtreeElements(chapter, true));
+    }
+
+    void XMLEditor::FinishTextIndex()
+    {
+        for (AttributeIndex& index : attributeIndexes)
+        {
+            BuildValueTrigrams(index);
+        }
+        textIndexReady = true;
+        textIndexThreads = 1;
+
+        // Para indexar el texto se han leído todos los capítulos
+        pendingChapters = false;
+    }
+
+    std::vector<tinyxml2::XMLElement*> XMLEditor::SubtreeElements(tinyxml2::XMLElement* node, bool includeNode)
+    {
+        std::vector<tinyxml2::XMLElement*> elements;
+        ElementCursor cursor(node);
+        if (!includeNode)
+        {
+            cursor.Next();
+        }
+        for (; cursor; cursor.Next())
+        {
+            elements.push_back(cursor.Current());
+        }
+        return elements;
+    }
+
+    void XMLEditor::BuildNameIndex()
+    {
+        nameIndex.clear();
+        for (AttributeIndex& index : attributeIndexes)
+        {
+            index.nodes.clear();
+            index.words.clear();
+            index.valueTrigramsReady = false;
+        }
+        tinyxml2::XMLElement* root = xmlDoc.RootElement();
+        if (root == nullptr)
+        {
+            return;
+        }
+        // Los mismos pocos nombres se repiten mucho: se recuerdan las últimas listas usadas
+        // para no calcular el hash de cada elemento
+        struct RecentName
+        {
+            const char* name = nullptr;
+            std::vector<tinyxml2::XMLElement*>* nodes = nullptr;
+        };
+        RecentName recent[4];
+        std::size_t nextRecent = 0;
+        for (ElementCursor cursor(root); cursor; cursor.Next())
+        {
+            tinyxml2::XMLElement* element = cursor.Current();
+            const char* name = element->Name();
+            std::vector<tinyxml2::XMLElement*>* nodes = nullptr;
+            for (const RecentName& entry : recent)
+            {
+                if (entry.name != nullptr && std::strcmp(entry.name, name) == 0)
+                {
+                    nodes = entry.nodes;
+                    break;
+                }
+            }
+            if (nodes == nullptr)
+            {
+                nodes = &nameIndex[name];
+                recent[nextRecent] = { name, nodes };
+                nextRecent = (nextRecent + 1) % 4;
+            }
+            nodes->push_back(element);
+        }
+
+        for (AttributeIndex& index : attributeIndexes)
+        {
+            BuildAttributeIndex(index);
+        }
+    }
+
+    void XMLEditor::IndexElements(const std::vector<tinyxml2::XMLElement*>& elements)
+    {
+        for (AttributeIndex& index : attributeIndexes)
+        {
+            for (tinyxml2::XMLElement* element : elements)
+            {
+                if (index.nodeName == element->Name())
+                {
+                    IndexAttribute(index, element, element->Attribute(index.attributeName.c_str()));
+                }
+            }
+        }
+
+        // Los elementos de cada nombre van seguidos en su lista: se insertan de una vez
+        std::unordered_map<std::string, std::vector<tinyxml2::XMLElement*>> groups;
+        for (tinyxml2::XMLElement* element : elements)
+        {
+            groups[element->Name()].push_back(element);
+        }
+        for (auto& group : groups)
+        {
+            std::vector<tinyxml2::XMLElement*>& nodes = nameIndex[group.first];
+            auto position = nodes.end();
+            if (!nodes.empty() && !IsBefore(nodes.back(), group.second.front()))
+            {
+                position = std::upper_bound(nodes.begin(), nodes.end(), group.second.front(), IsBefore);
+            }
+            nodes.insert(position, group.second.begin(), group.second.end());
+        }
+    }
+
+    void XMLEditor::UnindexElements(const std::vector<tinyxml2::XMLElement*>& elements)
+    {
+        for (AttributeIndex& index : attributeIndexes)
+        {
+            for (tinyxml2::XMLElement* element : elements)
+            {
+                if (index.nodeName == element->Name())
+                {
+                    UnindexAttribute(index, element, element->Attribute(index.attributeName.c_str()));
+                }
+            }
+        }
+
+        std::unordered_map<std::string, std::vector<tinyxml2::XMLElement*>> groups;
+        for (tinyxml2::XMLElement* element : elements)
+        {
+            groups[element->Name()].push_back(element);
+        }
+        for (auto& group : groups)
+        {
+            const auto found = nameIndex.find(group.first);
+            if (found == nameIndex.end())
+            {
+                continue;
+            }
+            std::vector<tinyxml2::XMLElement*>& nodes = found->second;
+            const std::size_t count = group.second.size();
+            const auto first = std::lower_bound(nodes.begin(), nodes.end(), group.second.front(), IsBefore);
+            if (static_cast<std::size_t>(nodes.end() - first) >= count && std::equal(group.second.begin(), group.second.end(), first))
+            {
+                nodes.erase(first, first + count);
+            }
+            else
+            {
+                // No deberían estar separados; se quitan uno a uno
+                for (tinyxml2::XMLElement* element : group.second)
+                {
+                    nodes.erase(std::remove(nodes.begin(), nodes.end(), element), nodes.end());
+                }
+            }
+            if (nodes.empty())
+            {
+                nameIndex.erase(found);
+            }
+        }
+    }
+
+    void XMLEditor::AddAttributeIndex(const std::string& nodeName, const std::string& attributeName)
+    {
+        if (FindAttributeIndex(nodeName, attributeName) != nullptr)
+        {
+            return;
+        }
+        AttributeIndex& index = attributeIndexes.emplace_back();
+        index.nodeName = nodeName;
+        index.attributeName = attributeName;
+        BuildAttributeIndex(index);
+    }
+
+    bool XMLEditor::HasAttributeIndex(const std::string& nodeName, const std::string& attributeName) const
+    {
+        return std::any_of(attributeIndexes.begin(), attributeIndexes.end(), [&](const AttributeIndex& index) {
+            return index.nodeName == nodeName && index.attributeName == attributeName;
+        });
+    }
+
+    tinyxml2::XMLElement* XMLEditor::GetNodeByAttribute(const std::string& nodeName, const std::string& attributeName, const std::string& attributeValue)
+    {
+        const std::vector<tinyxml2::XMLElement*>& nodes = GetNodesByAttribute(nodeName, attributeName, attributeValue);
+        return nodes.empty() ? nullptr : nodes.front();
+    }
+
+    const std::vector<tinyxml2::XMLElement*>& XMLEditor::GetNodesByAttribute(const std::string& nodeName, const std::string& attributeName,
+        const std::string& attributeValue)
+    {
+        static const std::vector<tinyxml2::XMLElement*> noNodes;
+        ExpandAllNodes();
+        AddAttributeIndex(nodeName, attributeName);
+        const AttributeIndex* index = FindAttributeIndex(nodeName, attributeName);
+        const auto found = index->nodes.find(attributeValue);
+        return found == index->nodes.end() ? noNodes : found->second;
+    }
+
+    std::vector<CharacterStats> XMLEditor::GetCharacters()
+    {
+        // Sin leer los capítulos pendientes: ExpandNode suma cada uno al leerlo
+        const AttributeIndex* index = FindAttributeIndex("personaje", "nombre");
+        std::vector<CharacterStats> characters;
+        characters.reserve(index->nodes.size());
+        for (const auto& entry : index->nodes)
+        {
+            const auto words = index->words.find(entry.first);
+            characters.push_back({ entry.first, entry.second.size(), words == index->words.end() ? 0 : words->second });
+        }
+        std::sort(characters.begin(), characters.end(), [](const CharacterStats& a, const CharacterStats& b) { return a.name < b.name; });
+        return characters;
+    }
+
+    const std::vector<tinyxml2::XMLElement*>& XMLEditor::GetCharacterLines(const std::string& characterName)
+    {
+        static const std::vector<tinyxml2::XMLElement*> noNodes;
+        const AttributeIndex* index = FindAttributeIndex("personaje", "nombre");
+        const auto found = index->nodes.find(characterName);
+        return found == index->nodes.end() ? noNodes : found->second;
+    }
+
+    XMLEditor::AttributeIndex* XMLEditor::FindAttributeIndex(const std::string& nodeName, const std::string& attributeName)
+    {
+        // Hay pocos pares; se buscan uno a uno
+        for (AttributeIndex& index : attributeIndexes)
+        {
+            if (index.nodeName == nodeName && index.attributeName == attributeName)
+            {
+                return &index;
+            }
+        }
+        return nullptr;
+    }
+
+    void XMLEditor::BuildValueTrigrams(AttributeIndex& index)
+    {
+        if (!index.fuzzy || index.valueTrigramsReady)
+        {
+            return;
+        }
+        index.valueTrigrams.Clear();
+        index.fuzzyValues.clear();
+        for (const auto& entry : index.nodes)
+        {
+            index.valueTrigrams.Add(static_cast<std::uint32_t>(index.fuzzyValues.size()), NormalizeValue(entry.first.c_str()));
+            index.fuzzyValues.push_back(entry.first);
+        }
+        index.valueTrigramsReady = true;
+    }
+
+    void XMLEditor::BuildAttributeIndex(AttributeIndex& index)
+    {
+        // La lista de nombres ya está en el orden del documento
+        index.nodes.clear();
+        index.words.clear();
+        index.valueTrigramsReady = false;
+        const auto found = nameIndex.find(index.nodeName);
+        if (found == nameIndex.end())
+        {
+            return;
+        }
+        for (tinyxml2::XMLElement* element : found->second)
+        {
+            if (const char* value = element->Attribute(index.attributeName.c_str()))
+            {
+                index.nodes[value].push_back(element);
+                if (index.countWords)
+                {
+                    index.words[value] += CountWords(element->GetText());
+                }
+            }
+        }
+    }
+
+    void XMLEditor::IndexAttribute(AttributeIndex& index, tinyxml2::XMLElement* element, const char* value)
+    {
+        if (value == nullptr)
+        {
+            return;
+        }
+        std::vector<tinyxml2::XMLElement*>& nodes = index.nodes[value];
+        if (nodes.empty())
+        {
+            // Valor nuevo: hay que rehacer sus trigramas
+            index.valueTrigramsReady = false;
+        }
+        auto position = nodes.end();
+        if (!nodes.empty() && !IsBefore(nodes.back(), element))
+        {
+            position = std::upper_bound(nodes.begin(), nodes.end(), element, IsBefore);
+        }
+        nodes.insert(position, element);
+        if (index.countWords)
+        {
+            index.words[value] += CountWords(element->GetText());
+        }
+    }
+
+    void XMLEditor::UnindexAttribute(AttributeIndex& index, tinyxml2::XMLElement* element, const char* value)
+    {
+        if (value == nullptr)
+        {
+            return;
+        }
+        const auto found = index.nodes.find(value);
+        if (found == index.nodes.end())
+        {
+            return;
+        }
+        std::vector<tinyxml2::XMLElement*>& nodes = found->second;
+        const auto removed = std::remove(nodes.begin(), nodes.end(), element);
+        if (index.countWords && removed != nodes.end())
+        {
+            std::size_t& words = index.words[value];
+            words -= std::min(words, CountWords(element->GetText()));
+        }
+        nodes.erase(removed, nodes.end());
+        if (nodes.empty())
+        {
+            index.nodes.erase(found);
+            index.words.erase(value);
+            index.valueTrigramsReady = false;
+        }
+    }
+
+    void XMLEditor::IndexAttributes(AttributeIndex& index, const std::vector<tinyxml2::XMLElement*>& elements)
+    {
+        std::unordered_map<std::string, std::vector<tinyxml2::XMLElement*>> byValue;
+        for (tinyxml2::XMLElement* element : elements)
+        {
+            if (const char* value = element->Attribute(index.attributeName.c_str()))
+            {
+                byValue[value].push_back(element);
+            }
+        }
+        for (auto& group : byValue)
+        {
+            const std::vector<tinyxml2::XMLElement*>& added = group.second;
+            std::vector<tinyxml2::XMLElement*>& nodes = index.nodes[group.first];
+            if (nodes.empty())
+            {
+                index.valueTrigramsReady = false;
+            }
+
+            // Si no van todos al final se mezclan con los que había, las dos listas ya en orden
+            const std::size_t previous = nodes.size();
+            nodes.insert(nodes.end(), added.begin(), added.end());
+            if (previous > 0 && !IsBefore(nodes[previous - 1], nodes[previous]))
+            {
+                std::inplace_merge(nodes.begin(), nodes.begin() + static_cast<std::ptrdiff_t>(previous), nodes.end(), IsBefore);
+            }
+            if (index.countWords)
+            {
+                std::size_t& words = index.words[group.first];
+                for (const tinyxml2::XMLElement* element : added)
+                {
+                    words += CountWords(element->GetText());
+                }
+            }
+        }
+    }
+
+    void XMLEditor::UnindexAttributes(AttributeIndex& index, const std::vector<tinyxml2::XMLElement*>& elements)
+    {
+        std::unordered_map<std::string, std::unordered_set<const tinyxml2::XMLElement*>> byValue;
+        for (const tinyxml2::XMLElement* element : elements)
+        {
+            if (const char* value = element->Attribute(index.attributeName.c_str()))
+            {
+                byValue[value].insert(element);
+            }
+        }
+        for (const auto& group : byValue)
+        {
+            const auto found = index.nodes.find(group.first);
+            if (found == index.nodes.end())
+            {
+                continue;
+            }
+            std::vector<tinyxml2::XMLElement*>& nodes = found->second;
+            std::size_t removedWords = 0;
+            nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [&](const tinyxml2::XMLElement* element) {
+                if (group.second.count(element) == 0)
+                {
+                    return false;
+                }
+                removedWords += index.countWords ? CountWords(element->GetText()) : 0;
+                return true;
+            }), nodes.end());
+            if (index.countWords)
+            {
+                std::size_t& words = index.words[group.first];
+                words -= std::min(words, removedWords);
+            }
+            if (nodes.empty())
+            {
+                index.nodes.erase(found);
+                index.words.erase(group.first);
+                index.valueTrigramsReady = false;
+            }
+        }
+    }
+
+    void XMLEditor::CountIndexedWords(const tinyxml2::XMLElement* node, bool add)
+    {
+        for (AttributeIndex& index : attributeIndexes)
+        {
+            if (!index.countWords || index.nodeName != node->Name())
+            {
+                continue;
+            }
+            const char* value = node->Attribute(index.attributeName.c_str());
+            const auto words = value ? index.words.find(value) : index.words.end();
+            if (words == index.words.end())
+            {
+                continue;
+            }
+            const std::size_t count = CountWords(node->GetText());
+            words->second = add ? words->second + count : words->second - std::min(words->second, count);
+        }
+    }
+
+    bool XMLEditor::IsBefore(const tinyxml2::XMLNode* a, const tinyxml2::XMLNode* b)
+    {
+        if (a == b)
+        {
+            return false;
+        }
+
+        // Se suben los dos nodos hasta la misma profundidad
+        int depthA = 0;
+        int depthB = 0;
+        for (const tinyxml2::XMLNode* node = a->Parent(); node != nullptr; node = node->Parent())
+        {
+            depthA++;
+        }
+        for (const tinyxml2::XMLNode* node = b->Parent(); node != nullptr; node = node->Parent())
+        {
+            depthB++;
+        }
+        const tinyxml2::XMLNode* ancestorA = a;
+        const tinyxml2::XMLNode* ancestorB = b;
+        for (; depthA > depthB; depthA--)
+        {
+            ancestorA = ancestorA->Parent();
+        }
+        for (; depthB > depthA; depthB--)
+        {
+            ancestorB = ancestorB->Parent();
+        }
+        if (ancestorA == ancestorB)
+        {
+            // Uno contiene al otro: el que contiene va antes
+            return ancestorA == a;
+        }
+        while (ancestorA->Parent() != ancestorB->Parent())
+        {
+            ancestorA = ancestorA->Parent();
+            ancestorB = ancestorB->Parent();
+        }
+
+        // Hermanos: se busca a B en las dos direcciones a la vez desde A
+        const tinyxml2::XMLNode* next = ancestorA;
+        const tinyxml2::XMLNode* previous = ancestorA;
+        while (next != nullptr || previous != nullptr)
+        {
+            if (next != nullptr && (next = next->NextSibling()) == ancestorB)
+            {
+                return true;
+            }
+            if (previous != nullptr && (previous = previous->PreviousSibling()) == ancestorB)
+            {
+                return false;
+            }
+        }
+        return false;
+    }
+
+}
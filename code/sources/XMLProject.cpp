@@ -0,0 +1,268 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#include <stdexcept>
+#include <fstream>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#include "../headers/XMLProject.hpp"
+#include "../headers/WorkerPool.hpp"
+
+namespace xmlEditor
+{
+    namespace
+    {
+        // Indica si una ruta ya normalizada queda dentro de la carpeta base (también normalizada)
+        bool IsInside(const std::filesystem::path& base, const std::filesystem::path& target)
+        {
+            const std::filesystem::path relative = target.lexically_relative(base);
+            return !relative.empty() && *relative.begin() != ".." && !relative.has_root_path();
+        }
+    }
+
+    XMLProject::XMLProject() { }
+
+    XMLProject::~XMLProject() { }
+
+    std::vector<std::string> XMLProject::ListFiles(const std::string& path, std::vector<std::string>& relativePaths)
+    {
+        std::vector<std::string> files;
+        relativePaths.clear();
+
+        std::error_code error;
+        const std::filesystem::path projectPath(path);
+        if (std::filesystem::is_directory(projectPath, error))
+        {
+            // Carpeta: todos los .xml, también los de las subcarpetas
+            for (std::filesystem::recursive_directory_iterator it(projectPath, error), end; !error && it != end; it.increment(error))
+            {
+                if (it->is_regular_file(error) && it->path().extension() == ".xml")
+                {
+                    relativePaths.push_back(std::filesystem::relative(it->path(), projectPath, error).generic_string());
+                }
+            }
+            if (error)
+            {
+                // Lanza un aviso en caso de error al leer la carpeta
+                throw std::runtime_error("Failed to read project folder");
+            }
+            std::sort(relativePaths.begin(), relativePaths.end());
+            for (const std::string& relativePath : relativePaths)
+            {
+                files.push_back((projectPath / relativePath).string());
+            }
+            return files;
+        }
+
+        // Archivo de proyecto: una ruta por línea
+        std::ifstream manifest(path);
+        if (!manifest.is_open())
+        {
+            // Lanza un aviso en caso de error al abrir el archivo
+            throw std::runtime_error("Failed to open project file");
+        }
+        std::string line;
+        while (std::getline(manifest, line))
+        {
+            const std::size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#')
+            {
+                continue;
+            }
+            const std::size_t last = line.find_last_not_of(" \t\r");
+            const std::string entry = line.substr(first, last - first + 1);
+
+            // Solo rutas dentro de la carpeta del proyecto: al guardar se escriben ahí con esta ruta
+            const std::filesystem::path relativePath = std::filesystem::path(entry).lexically_normal();
+            if (relativePath.has_root_path() || relativePath.empty() || *relativePath.begin() == ".." || relativePath == ".")
+            {
+                throw std::runtime_error("Project file path outside the project folder: " + entry);
+            }
+            relativePaths.push_back(relativePath.generic_string());
+            files.push_back((projectPath.parent_path() / relativePath).string());
+        }
+        return files;
+    }
+
+    void XMLProject::Open(const std::string& path, const LoadOptions& options)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::string> paths;
+        const std::vector<std::string> files = ListFiles(path, paths);
+        if (files.empty())
+        {
+            throw std::runtime_error("Project has no XML files");
+        }
+
+        // Tamaño total para el progreso conjunto
+        std::vector<std::size_t> sizes(files.size(), 0);
+        std::size_t totalBytes = 0;
+        for (std::size_t i = 0; i < files.size(); i++)
+        {
+            std::error_code error;
+            const std::uintmax_t size = std::filesystem::file_size(files[i], error);
+            sizes[i] = error ? 0 : static_cast<std::size_t>(size);
+            totalBytes += sizes[i];
+        }
+
+        // Cada archivo se lee en un solo hilo; el paralelismo está en leer varios a la vez
+        std::vector<std::unique_ptr<XMLEditor>> loaded(files.size());
+        std::atomic<std::size_t> parsedBytes(0);
+        std::atomic<bool> cancelled(false);
+        std::atomic<std::size_t> firstFailure(files.size());
+        std::mutex progressMutex;
+        std::vector<std::string> errors(files.size());
+
+        RunParallel(files.size(), options.parseThreads, [&](std::size_t index) {
+            // Tras un error solo se leen los archivos anteriores, que podrían fallar antes
+            if (cancelled || index > firstFailure)
+            {
+                return;
+            }
+
+            LoadOptions fileOptions = options;
+            fileOptions.parseThreads = 1;
+            std::size_t reported = 0;
+            auto report = [&](std::size_t fileBytes) {
+                parsedBytes += fileBytes - reported;
+                reported = fileBytes;
+                if (!options.progress)
+                {
+                    return !cancelled;
+                }
+                // La función de progreso se llama desde un hilo cada vez
+                std::lock_guard<std::mutex> lock(progressMutex);
+                if (!cancelled && !options.progress(parsedBytes.load(), totalBytes))
+                {
+                    cancelled = true;
+                }
+                return !cancelled;
+            };
+            fileOptions.progress = [&](std::size_t fileBytes, std::size_t) {
+                return report(fileBytes);
+            };
+
+            std::unique_ptr<XMLEditor> editor = std::make_unique<XMLEditor>();
+            try {
+                editor->OpenFile(files[index], fileOptions);
+            }
+            catch (std::runtime_error& e) {
+                errors[index] = e.what();
+                std::size_t failure = firstFailure;
+                while (index < failure && !firstFailure.compare_exchange_weak(failure, index)) { }
+                return;
+            }
+            report(sizes[index]);
+            loaded[index] = std::move(editor);
+        });
+
+        if (cancelled)
+        {
+            throw std::runtime_error("File loading cancelled");
+        }
+        for (std::size_t i = 0; i < files.size(); i++)
+        {
+            if (!errors[i].empty())
+            {
+                // Lanza un aviso con el primer archivo que no se pudo leer
+                throw std::runtime_error(paths[i] + ": " + errors[i]);
+            }
+        }
+
+        documents = std::move(loaded);
+        relativePaths = std::move(paths);
+        name = std::filesystem::path(path).filename().string();
+        if (name.empty())
+        {
+            name = std::filesystem::path(path).parent_path().filename().string();
+        }
+
+        // Guarda las medidas de la carga
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        loadStats.memoryMapped = options.memoryMapped;
+        loadStats.bytes = totalBytes;
+        loadStats.seconds = elapsed.count();
+        loadStats.megabytesPerSecond = loadStats.seconds > 0.0 ? (loadStats.bytes / (1024.0 * 1024.0)) / loadStats.seconds : 0.0;
+        loadStats.peakResidentBytes = XMLEditor::PeakResidentBytes();
+    }
+
+    std::size_t XMLProject::GetDocumentCount() const
+    {
+        return documents.size();
+    }
+
+    XMLEditor& XMLProject::GetDocument(std::size_t index)
+    {
+        if (index >= documents.size())
+        {
+            throw std::out_of_range("Document index out of range");
+        }
+        return *documents[index];
+    }
+
+    const std::string& XMLProject::GetRelativePath(std::size_t index) const
+    {
+        if (index >= relativePaths.size())
+        {
+            throw std::out_of_range("Document index out of range");
+        }
+        return relativePaths[index];
+    }
+
+    XMLEditor* XMLProject::FindDocument(const tinyxml2::XMLElement* node)
+    {
+        for (const std::unique_ptr<XMLEditor>& document : documents)
+        {
+            if (document->Contains(node))
+            {
+                return document.get();
+            }
+        }
+        return nullptr;
+    }
+
+    const std::string& XMLProject::GetName() const
+    {
+        return name;
+    }
+
+    void XMLProject::SaveAll(const std::string& directory)
+    {
+        // Se comprueban todas las rutas antes de escribir nada
+        const std::filesystem::path base = std::filesystem::path(directory).lexically_normal();
+        std::vector<std::filesystem::path> targets;
+        for (const std::string& relativePath : relativePaths)
+        {
+            targets.push_back((base / relativePath).lexically_normal());
+            if (!IsInside(base, targets.back()))
+            {
+                throw std::runtime_error("Project file path outside the save folder: " + relativePath);
+            }
+        }
+
+        for (std::size_t i = 0; i < documents.size(); i++)
+        {
+            const std::filesystem::path& target = targets[i];
+            std::error_code error;
+
+            // Un archivo sin cambios que ya está en su sitio no se vuelve a escribir
+            if (!documents[i]->IsModified() && std::filesystem::equivalent(target, documents[i]->GetFilePath(), error) && !error)
+            {
+                continue;
+            }
+            std::filesystem::create_directories(target.parent_path(), error);
+            documents[i]->SaveFileAs(target.string());
+        }
+    }
+
+    const LoadStats& XMLProject::GetLoadStats() const
+    {
+        return loadStats;
+    }
+}
@@ -0,0 +1,547 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#include "../headers/XMLQuery.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace xmlEditor
+{
+    namespace
+    {
+        // Lee un número que ocupa todo el texto (con espacios alrededor)
+        bool ParseNumber(const char* text, double& number)
+        {
+            char* end = nullptr;
+            number = std::strtod(text, &end);
+            if (end == text)
+            {
+                return false;
+            }
+            while (std::isspace(static_cast<unsigned char>(*end)))
+            {
+                ++end;
+            }
+            return *end == '\0';
+        }
+
+        bool IsNameChar(char c)
+        {
+            // Los bytes de UTF-8 por encima de 0x7F valen para los nombres con tildes o ñ
+            const unsigned char byte = static_cast<unsigned char>(c);
+            return std::isalnum(byte) || byte >= 0x80 || c == '_' || c == '-' || c == '.' || c == ':';
+        }
+    }
+
+    XMLQuery::XMLQuery(const std::string& expression) : expression(expression)
+    {
+        Parse();
+    }
+
+    XMLQuery::~XMLQuery()
+    {
+    }
+
+    const std::string& XMLQuery::GetExpression() const
+    {
+        return expression;
+    }
+
+    bool XMLQuery::UsesIndexes() const
+    {
+        return indexable;
+    }
+
+    void XMLQuery::Parse()
+    {
+        cursor = 0;
+        SkipSpaces();
+        if (cursor == expression.size())
+        {
+            Fail("empty expression");
+        }
+
+        Axis axis = Axis::Child;
+        if (Accept("//"))
+        {
+            axis = Axis::Descendant;
+        }
+        else
+        {
+            Accept("/");
+        }
+        while (true)
+        {
+            Step step;
+            step.axis = axis;
+            SkipSpaces();
+            if (!Accept("*"))
+            {
+                step.name = ParseName();
+            }
+            SkipSpaces();
+            while (Accept("["))
+            {
+                Predicate predicate = ParsePredicate();
+                if (predicate.position != 0 || predicate.last)
+                {
+                    predicate.slot = positionSlots++;
+                }
+                step.predicates.push_back(std::move(predicate));
+                SkipSpaces();
+            }
+            steps.push_back(std::move(step));
+
+            if (cursor == expression.size())
+            {
+                break;
+            }
+            if (Accept("//"))
+            {
+                axis = Axis::Descendant;
+            }
+            else if (Accept("/"))
+            {
+                axis = Axis::Child;
+            }
+            else
+            {
+                Fail("expected '/' or '['");
+            }
+        }
+
+        // last() se comprueba contando antes los hermanos que cumplen los predicados anteriores,
+        // así que no puede ir detrás de otra posición
+        for (const Step& step : steps)
+        {
+            bool positional = false;
+            for (const Predicate& predicate : step.predicates)
+            {
+                if (predicate.last && positional)
+                {
+                    throw std::invalid_argument("Invalid query: last() after another position is not supported: " + expression);
+                }
+                positional = positional || predicate.position != 0 || predicate.last;
+            }
+        }
+        indexable = positionSlots == 0 && !steps.back().name.empty();
+    }
+
+    XMLQuery::Predicate XMLQuery::ParsePredicate()
+    {
+        Predicate predicate;
+        SkipSpaces();
+        if (Accept("last()"))
+        {
+            predicate.last = true;
+        }
+        else if (cursor < expression.size() && std::isdigit(static_cast<unsigned char>(expression[cursor])))
+        {
+            std::size_t end = cursor;
+            while (end < expression.size() && std::isdigit(static_cast<unsigned char>(expression[end])))
+            {
+                ++end;
+            }
+            predicate.position = std::atoi(expression.substr(cursor, end - cursor).c_str());
+            if (predicate.position <= 0)
+            {
+                Fail("positions start at 1");
+            }
+            cursor = end;
+        }
+        else
+        {
+            predicate.conditions.push_back(ParseCondition());
+            SkipSpaces();
+            while (Accept("and"))
+            {
+                predicate.conditions.push_back(ParseCondition());
+                SkipSpaces();
+            }
+        }
+        SkipSpaces();
+        if (!Accept("]"))
+        {
+            Fail("expected ']'");
+        }
+        return predicate;
+    }
+
+    XMLQuery::Condition XMLQuery::ParseCondition()
+    {
+        Condition condition;
+        SkipSpaces();
+        if (!Accept("@"))
+        {
+            Fail("expected '@'");
+        }
+        condition.attribute = ParseName();
+        SkipSpaces();
+
+        // Los operadores de dos caracteres primero
+        if (Accept("!="))
+        {
+            condition.comparison = Comparison::NotEqual;
+        }
+        else if (Accept("<="))
+        {
+            condition.comparison = Comparison::LessEqual;
+        }
+        else if (Accept(">="))
+        {
+            condition.comparison = Comparison::GreaterEqual;
+        }
+        else if (Accept("="))
+        {
+            condition.comparison = Comparison::Equal;
+        }
+        else if (Accept("<"))
+        {
+            condition.comparison = Comparison::Less;
+        }
+        else if (Accept(">"))
+        {
+            condition.comparison = Comparison::Greater;
+        }
+        else
+        {
+            return condition;
+        }
+
+        SkipSpaces();
+        condition.value = ParseLiteral(condition.numeric);
+        if (condition.numeric)
+        {
+            ParseNumber(condition.value.c_str(), condition.number);
+        }
+        else if (condition.comparison != Comparison::Equal && condition.comparison != Comparison::NotEqual)
+        {
+            // <, <=, > y >= solo comparan números, aunque vengan entre comillas
+            if (!ParseNumber(condition.value.c_str(), condition.number))
+            {
+                Fail("expected a number");
+            }
+            condition.numeric = true;
+        }
+        return condition;
+    }
+
+    std::string XMLQuery::ParseName()
+    {
+        const std::size_t start = cursor;
+        while (cursor < expression.size() && IsNameChar(expression[cursor]))
+        {
+            ++cursor;
+        }
+        if (cursor == start)
+        {
+            Fail("expected a name");
+        }
+        return expression.substr(start, cursor - start);
+    }
+
+    std::string XMLQuery::ParseLiteral(bool& numeric)
+    {
+        numeric = false;
+        if (cursor < expression.size() && (expression[cursor] == '\'' || expression[cursor] == '"'))
+        {
+            const char quote = expression[cursor];
+            const std::size_t end = expression.find(quote, cursor + 1);
+            if (end == std::string::npos)
+            {
+                Fail("unterminated string");
+            }
+            std::string value = expression.substr(cursor + 1, end - cursor - 1);
+            cursor = end + 1;
+            return value;
+        }
+
+        const char* start = expression.c_str() + cursor;
+        char* end = nullptr;
+        std::strtod(start, &end);
+        if (end == start)
+        {
+            Fail("expected a string or a number");
+        }
+        const std::size_t length = end - start;
+        numeric = true;
+        cursor += length;
+        return expression.substr(cursor - length, length);
+    }
+
+    void XMLQuery::SkipSpaces()
+    {
+        while (cursor < expression.size() && std::isspace(static_cast<unsigned char>(expression[cursor])))
+        {
+            ++cursor;
+        }
+    }
+
+    bool XMLQuery::Accept(const char* token)
+    {
+        const std::size_t length = std::strlen(token);
+        if (expression.compare(cursor, length, token) != 0)
+        {
+            return false;
+        }
+        cursor += length;
+        return true;
+    }
+
+    void XMLQuery::Fail(const char* reason) const
+    {
+        throw std::invalid_argument("Invalid query: " + std::string(reason) + " at position " + std::to_string(cursor) + ": " + expression);
+    }
+
+    bool XMLQuery::MatchesCondition(const tinyxml2::XMLElement* element, const Condition& condition)
+    {
+        const char* value = element->Attribute(condition.attribute.c_str());
+        if (value == nullptr)
+        {
+            // Sin el atributo no se cumple ninguna comparación, tampoco !=
+            return false;
+        }
+        if (condition.comparison == Comparison::Exists)
+        {
+            return true;
+        }
+        if (!condition.numeric)
+        {
+            const bool equal = condition.value == value;
+            return condition.comparison == Comparison::Equal ? equal : !equal;
+        }
+
+        double number = 0.0;
+        if (!ParseNumber(value, number))
+        {
+            // Un valor que no es un número solo es distinto de cualquier número
+            return condition.comparison == Comparison::NotEqual;
+        }
+        switch (condition.comparison)
+        {
+        case Comparison::Equal:
+            return number == condition.number;
+        case Comparison::NotEqual:
+            return number != condition.number;
+        case Comparison::Less:
+            return number < condition.number;
+        case Comparison::LessEqual:
+            return number <= condition.number;
+        case Comparison::Greater:
+            return number > condition.number;
+        case Comparison::GreaterEqual:
+            return number >= condition.number;
+        default:
+            return false;
+        }
+    }
+
+    bool XMLQuery::MatchesName(const tinyxml2::XMLElement* element, const Step& step)
+    {
+        return step.name.empty() || step.name == element->Name();
+    }
+
+    bool XMLQuery::MatchesPredicates(const tinyxml2::XMLElement* element, const Step& step, std::size_t count) const
+    {
+        // Solo predicados de condiciones: los de posición dependen de los hermanos
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            for (const Condition& condition : step.predicates[i].conditions)
+            {
+                if (!MatchesCondition(element, condition))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool XMLQuery::MatchesStep(const tinyxml2::XMLElement* element, const Step& step, std::vector<PositionCounter>& counters) const
+    {
+        if (!MatchesName(element, step))
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < step.predicates.size(); ++i)
+        {
+            const Predicate& predicate = step.predicates[i];
+            if (predicate.position == 0 && !predicate.last)
+            {
+                for (const Condition& condition : predicate.conditions)
+                {
+                    if (!MatchesCondition(element, condition))
+                    {
+                        return false;
+                    }
+                }
+                continue;
+            }
+
+            // Cada hermano que llega hasta aquí avanza el contador de este predicado
+            PositionCounter& counter = counters[predicate.slot];
+            ++counter.count;
+            if (predicate.position != 0)
+            {
+                if (counter.count != predicate.position)
+                {
+                    return false;
+                }
+                continue;
+            }
+            if (counter.total < 0)
+            {
+                // Los hermanos que cumplen el nombre y las condiciones anteriores, contados una vez
+                counter.total = 0;
+                for (const tinyxml2::XMLElement* sibling = element->Parent()->FirstChildElement(); sibling != nullptr;
+                    sibling = sibling->NextSiblingElement())
+                {
+                    if (MatchesName(sibling, step) && MatchesPredicates(sibling, step, i))
+                    {
+                        ++counter.total;
+                    }
+                }
+            }
+            if (counter.count != counter.total)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool XMLQuery::MatchesPath(const tinyxml2::XMLElement* element, std::size_t k) const
+    {
+        const tinyxml2::XMLElement* parent = element->Parent()->ToElement();
+        if (k == 0)
+        {
+            // El primer paso cuelga del documento
+            return steps[0].axis == Axis::Descendant || parent == nullptr;
+        }
+        const Step& previous = steps[k - 1];
+        for (const tinyxml2::XMLElement* ancestor = parent; ancestor != nullptr; ancestor = ancestor->Parent()->ToElement())
+        {
+            if (MatchesName(ancestor, previous) && MatchesPredicates(ancestor, previous, previous.predicates.size())
+                && MatchesPath(ancestor, k - 1))
+            {
+                return true;
+            }
+            if (steps[k].axis == Axis::Child)
+            {
+                break;
+            }
+        }
+        return false;
+    }
+
+    std::vector<tinyxml2::XMLElement*> XMLQuery::Run(XMLEditor& editor) const
+    {
+        if (!indexable || editor.GetRootNode() == nullptr)
+        {
+            return RunTraversal(editor);
+        }
+
+        // Candidatos del último paso: con una igualdad de texto, los del índice de ese atributo si el
+        // documento ya lo tiene (una consulta no crea índices que se quedarían para siempre); si no,
+        // todos los de ese nombre. Las listas ya están en el orden del documento.
+        const Step& step = steps.back();
+        const std::vector<tinyxml2::XMLElement*>* candidates = nullptr;
+        for (const Predicate& predicate : step.predicates)
+        {
+            for (const Condition& condition : predicate.conditions)
+            {
+                if (candidates == nullptr && condition.comparison == Comparison::Equal && !condition.numeric
+                    && editor.HasAttributeIndex(step.name, condition.attribute))
+                {
+                    candidates = &editor.GetNodesByAttribute(step.name, condition.attribute, condition.value);
+                }
+            }
+        }
+        if (candidates == nullptr)
+        {
+            candidates = &editor.GetNodesByName(step.name);
+        }
+
+        std::vector<tinyxml2::XMLElement*> results;
+        for (tinyxml2::XMLElement* element : *candidates)
+        {
+            if (MatchesPredicates(element, step, step.predicates.size()) && MatchesPath(element, steps.size() - 1))
+            {
+                results.push_back(element);
+            }
+        }
+        return results;
+    }
+
+    std::vector<tinyxml2::XMLElement*> XMLQuery::RunTraversal(XMLEditor& editor) const
+    {
+        std::vector<tinyxml2::XMLElement*> results;
+        tinyxml2::XMLElement* root = editor.GetRootNode();
+        if (root == nullptr)
+        {
+            return results;
+        }
+
+        // Un nivel del recorrido: los pasos que pueden cumplir los hijos de un elemento y sus
+        // contadores de posición. Los pasos de descendientes se heredan; los de hijos solo pasan
+        // al nivel siguiente, así que en una rama sin pasos el cursor salta los hijos.
+        struct Level
+        {
+            std::vector<std::size_t> expected;
+            std::vector<PositionCounter> counters;
+        };
+
+        // El primer nivel es el del documento, cuyo único hijo es la raíz
+        std::vector<Level> levels;
+        levels.push_back({ { 0 }, std::vector<PositionCounter>(positionSlots) });
+        std::vector<std::size_t> childExpected;
+        for (ElementCursor cursor(root); cursor; cursor.Next())
+        {
+            // Los niveles de las ramas ya terminadas se descartan
+            levels.resize(static_cast<std::size_t>(cursor.Depth()) + 1);
+            Level& level = levels.back();
+            tinyxml2::XMLElement* element = cursor.Current();
+
+            childExpected.clear();
+            bool matched = false;
+            for (const std::size_t k : level.expected)
+            {
+                const Step& step = steps[k];
+                if (step.axis == Axis::Descendant)
+                {
+                    childExpected.push_back(k);
+                }
+                if (MatchesStep(element, step, level.counters))
+                {
+                    if (k + 1 == steps.size())
+                    {
+                        matched = true;
+                    }
+                    else
+                    {
+                        childExpected.push_back(k + 1);
+                    }
+                }
+            }
+            if (matched)
+            {
+                results.push_back(element);
+            }
+            if (childExpected.empty())
+            {
+                cursor.SkipChildren();
+                continue;
+            }
+
+            // El capítulo se lee antes de que el cursor baje a sus hijos
+            std::sort(childExpected.begin(), childExpected.end());
+            childExpected.erase(std::unique(childExpected.begin(), childExpected.end()), childExpected.end());
+            editor.ExpandNode(element);
+            levels.push_back({ childExpected, std::vector<PositionCounter>(positionSlots) });
+        }
+        return results;
+    }
+}
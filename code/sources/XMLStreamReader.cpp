@@ -0,0 +1,468 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#include <stdexcept>
+#include <cstring>
+
+#include "../headers/XMLStreamReader.hpp"
+
+using tinyxml2::StrPair;
+using tinyxml2::XMLUtil;
+
+namespace xmlEditor
+{
+    XMLStreamReader::XMLStreamReader(std::size_t chunkSize) :
+        chunkSize(chunkSize > 0 ? chunkSize : 64 * 1024),
+        position(0),
+        filled(0),
+        bytesRead(0),
+        endOfFile(true),
+        attributeCount(0),
+        pendingEnd(false),
+        restoreTag(false),
+        lineNum(1),
+        parseLineNum(1),
+        current(StreamEvent::EndDocument)
+    {
+    }
+
+    XMLStreamReader::~XMLStreamReader() { }
+
+    void XMLStreamReader::Open(const std::string& filePath)
+    {
+        Close();
+        file.open(filePath, std::ios::in | std::ios::binary);
+        if (!file.is_open())
+        {
+            // Lanza un aviso en caso de error al abrir el archivo
+            throw std::runtime_error("Failed to open file");
+        }
+        buffer.assign(chunkSize + 1, 0);
+        endOfFile = false;
+
+        // Salta la marca BOM de UTF-8 si la hay; con bloques pequeños se lee hasta tener sus 3 bytes
+        while (filled < 3 && Refill()) { }
+        bool bom = false;
+        const char* start = XMLUtil::ReadBOM(buffer.data(), &bom);
+        position = start - buffer.data();
+    }
+
+    void XMLStreamReader::Close()
+    {
+        if (file.is_open())
+        {
+            file.close();
+        }
+        file.clear();
+        buffer.clear();
+        position = 0;
+        filled = 0;
+        bytesRead = 0;
+        endOfFile = true;
+        name.Reset();
+        text.Reset();
+        attributeCount = 0;
+        pendingEnd = false;
+        restoreTag = false;
+        lineNum = 1;
+        parseLineNum = 1;
+        current = StreamEvent::EndDocument;
+        openElements.clear();
+        closedName.clear();
+    }
+
+    StreamEvent XMLStreamReader::Next()
+    {
+        if (buffer.empty())
+        {
+            return StreamEvent::EndDocument;
+        }
+
+        // Un elemento vacío (<a/>) produce también su evento de cierre
+        if (pendingEnd)
+        {
+            pendingEnd = false;
+            closedName = openElements.back();
+            openElements.pop_back();
+            current = StreamEvent::EndElement;
+            return current;
+        }
+
+        for (;;)
+        {
+            StreamEvent event = StreamEvent::EndDocument;
+            const TokenResult result = ParseToken(event);
+            if (result == TokenResult::Event)
+            {
+                current = event;
+                return current;
+            }
+            if (result == TokenResult::NeedMoreData && !Refill())
+            {
+                // Fin del archivo
+                if (!openElements.empty())
+                {
+                    Fail("Unexpected end of file inside element " + openElements.back());
+                }
+                current = StreamEvent::EndDocument;
+                return current;
+            }
+        }
+    }
+
+    void XMLStreamReader::Run(XMLStreamHandler& handler)
+    {
+        for (;;)
+        {
+            bool keepGoing = true;
+            switch (Next())
+            {
+            case StreamEvent::StartElement:
+                keepGoing = handler.OnStartElement(*this);
+                break;
+            case StreamEvent::Text:
+                keepGoing = handler.OnText(*this);
+                break;
+            case StreamEvent::EndElement:
+                keepGoing = handler.OnEndElement(*this);
+                break;
+            case StreamEvent::EndDocument:
+                return;
+            }
+            if (!keepGoing)
+            {
+                return;
+            }
+        }
+    }
+
+    XMLStreamReader::TokenResult XMLStreamReader::ParseToken(StreamEvent& event)
+    {
+        // GetStr() termina el texto anterior escribiendo un cero sobre el '<' que lo seguía
+        if (restoreTag)
+        {
+            buffer[position] = '<';
+            restoreTag = false;
+        }
+
+        char* const start = buffer.data() + position;
+        parseLineNum = lineNum;
+
+        // Los espacios entre etiquetas no producen eventos, igual que en XMLDocument
+        char* p = XMLUtil::SkipWhiteSpace(start, &parseLineNum);
+        if (!*p)
+        {
+            if (endOfFile)
+            {
+                position = p - buffer.data();
+                lineNum = parseLineNum;
+            }
+            return TokenResult::NeedMoreData;
+        }
+
+        if (*p == '<')
+        {
+            lineNum = parseLineNum;
+            position = p - buffer.data();
+            return ParseTag(p, event);
+        }
+
+        // Texto: se lee desde el principio para conservar los espacios iniciales
+        parseLineNum = lineNum;
+        char* end = text.ParseText(start, "<", StrPair::TEXT_ELEMENT, &parseLineNum);
+        if (!end)
+        {
+            if (endOfFile)
+            {
+                Fail("Text outside of any element");
+            }
+            return TokenResult::NeedMoreData;
+        }
+        if (openElements.empty())
+        {
+            Fail("Text outside of any element");
+        }
+        position = (end - 1) - buffer.data();
+        restoreTag = true;
+        lineNum = parseLineNum;
+        event = StreamEvent::Text;
+        return TokenResult::Event;
+    }
+
+    XMLStreamReader::TokenResult XMLStreamReader::ParseTag(char* p, StreamEvent& event)
+    {
+        // Declaraciones, comentarios y DTD se saltan; CDATA se entrega como texto
+        static const char* xmlHeader = "<?";
+        static const char* commentHeader = "<!--";
+        static const char* cdataHeader = "<![CDATA[";
+        static const char* dtdHeader = "<!";
+
+        // Sin los bytes suficientes no se puede distinguir el tipo de etiqueta
+        if (!endOfFile)
+        {
+            for (int i = 1; i < 9; i++)
+            {
+                if (!p[i])
+                {
+                    return TokenResult::NeedMoreData;
+                }
+            }
+        }
+
+        StrPair skipped;
+        char* end = nullptr;
+        if (XMLUtil::StringEqual(p, xmlHeader, 2))
+        {
+            end = skipped.ParseText(p + 2, "?>", 0, &parseLineNum);
+        }
+        else if (XMLUtil::StringEqual(p, commentHeader, 4))
+        {
+            end = skipped.ParseText(p + 4, "-->", 0, &parseLineNum);
+        }
+        else if (XMLUtil::StringEqual(p, cdataHeader, 9))
+        {
+            end = text.ParseText(p + 9, "]]>", StrPair::NEEDS_NEWLINE_NORMALIZATION, &parseLineNum);
+            if (end)
+            {
+                if (openElements.empty())
+                {
+                    Fail("CDATA outside of any element");
+                }
+                position = end - buffer.data();
+                lineNum = parseLineNum;
+                event = StreamEvent::Text;
+                return TokenResult::Event;
+            }
+        }
+        else if (XMLUtil::StringEqual(p, dtdHeader, 2))
+        {
+            end = skipped.ParseText(p + 2, ">", 0, &parseLineNum);
+        }
+        else if (*(p + 1) == '/')
+        {
+            // Etiqueta de cierre
+            char* q = name.ParseName(p + 2);
+            if (q && *q)
+            {
+                q = XMLUtil::SkipWhiteSpace(q, &parseLineNum);
+            }
+            if (!q || !*q)
+            {
+                if (!q && *(p + 2))
+                {
+                    Fail("Malformed closing tag");
+                }
+                return TokenResult::NeedMoreData;
+            }
+            if (*q != '>')
+            {
+                Fail("Malformed closing tag");
+            }
+            if (openElements.empty() || openElements.back() != name.GetStr())
+            {
+                Fail(std::string("Mismatched closing tag ") + name.GetStr());
+            }
+            closedName = openElements.back();
+            openElements.pop_back();
+            position = (q + 1) - buffer.data();
+            lineNum = parseLineNum;
+            event = StreamEvent::EndElement;
+            return TokenResult::Event;
+        }
+        else
+        {
+            // Etiqueta de apertura con sus atributos
+            char* q = name.ParseName(p + 1);
+            if (!q)
+            {
+                if (!*(p + 1))
+                {
+                    return TokenResult::NeedMoreData;
+                }
+                Fail("Malformed element name");
+            }
+            attributeCount = 0;
+            for (;;)
+            {
+                q = XMLUtil::SkipWhiteSpace(q, &parseLineNum);
+                if (!*q)
+                {
+                    return TokenResult::NeedMoreData;
+                }
+                if (*q == '>')
+                {
+                    ++q;
+                    break;
+                }
+                if (*q == '/')
+                {
+                    if (!*(q + 1))
+                    {
+                        return TokenResult::NeedMoreData;
+                    }
+                    if (*(q + 1) != '>')
+                    {
+                        Fail("Malformed element");
+                    }
+                    q += 2;
+                    pendingEnd = true;
+                    break;
+                }
+                if (!XMLUtil::IsNameStartChar(static_cast<unsigned char>(*q)))
+                {
+                    Fail("Malformed element");
+                }
+
+                if (attributeCount == static_cast<int>(attributes.size()))
+                {
+                    attributes.push_back(std::make_unique<StreamAttribute>());
+                }
+                StreamAttribute& attribute = *attributes[attributeCount];
+                q = attribute.name.ParseName(q);
+                q = XMLUtil::SkipWhiteSpace(q, &parseLineNum);
+                if (!*q)
+                {
+                    return TokenResult::NeedMoreData;
+                }
+                if (*q != '=')
+                {
+                    Fail("Malformed attribute");
+                }
+                q = XMLUtil::SkipWhiteSpace(q + 1, &parseLineNum);
+                if (!*q)
+                {
+                    return TokenResult::NeedMoreData;
+                }
+                if (*q != '\'' && *q != '\"')
+                {
+                    Fail("Malformed attribute");
+                }
+                const char endTag[2] = { *q, 0 };
+                q = attribute.value.ParseText(q + 1, endTag, StrPair::ATTRIBUTE_VALUE, &parseLineNum);
+                if (!q)
+                {
+                    return TokenResult::NeedMoreData;
+                }
+                ++attributeCount;
+            }
+
+            openElements.emplace_back(name.GetStr());
+            position = q - buffer.data();
+            lineNum = parseLineNum;
+            event = StreamEvent::StartElement;
+            return TokenResult::Event;
+        }
+
+        if (!end)
+        {
+            return TokenResult::NeedMoreData;
+        }
+        position = end - buffer.data();
+        lineNum = parseLineNum;
+        return TokenResult::Skipped;
+    }
+
+    bool XMLStreamReader::Refill()
+    {
+        if (endOfFile)
+        {
+            return false;
+        }
+
+        // Descarta lo ya consumido y, si el token actual no cabe, agranda la ventana
+        const std::size_t pending = filled - position;
+        if (position > 0)
+        {
+            std::memmove(buffer.data(), buffer.data() + position, pending);
+            position = 0;
+            filled = pending;
+        }
+        if (filled + chunkSize + 1 > buffer.size())
+        {
+            buffer.resize(filled + chunkSize + 1);
+        }
+
+        file.read(buffer.data() + filled, static_cast<std::streamsize>(buffer.size() - 1 - filled));
+        const std::size_t count = static_cast<std::size_t>(file.gcount());
+        filled += count;
+        bytesRead += count;
+        buffer[filled] = 0;
+        if (count == 0 || file.eof())
+        {
+            endOfFile = true;
+        }
+        return true;
+    }
+
+    void XMLStreamReader::Fail(const std::string& message) const
+    {
+        // Lanza un aviso con la línea donde se encontró el error
+        throw std::runtime_error(message + " at line " + std::to_string(parseLineNum));
+    }
+
+    const char* XMLStreamReader::Name() const
+    {
+        if (current == StreamEvent::EndElement)
+        {
+            return closedName.c_str();
+        }
+        return current == StreamEvent::StartElement ? name.GetStr() : "";
+    }
+
+    const char* XMLStreamReader::Text() const
+    {
+        return current == StreamEvent::Text ? text.GetStr() : "";
+    }
+
+    int XMLStreamReader::AttributeCount() const
+    {
+        return current == StreamEvent::StartElement ? attributeCount : 0;
+    }
+
+    const char* XMLStreamReader::AttributeName(int index) const
+    {
+        if (index < 0 || index >= AttributeCount())
+        {
+            throw std::out_of_range("Attribute index out of range");
+        }
+        return attributes[index]->name.GetStr();
+    }
+
+    const char* XMLStreamReader::AttributeValue(int index) const
+    {
+        if (index < 0 || index >= AttributeCount())
+        {
+            throw std::out_of_range("Attribute index out of range");
+        }
+        return attributes[index]->value.GetStr();
+    }
+
+    const char* XMLStreamReader::Attribute(const char* attributeName) const
+    {
+        for (int i = 0; i < AttributeCount(); i++)
+        {
+            if (std::strcmp(attributes[i]->name.GetStr(), attributeName) == 0)
+            {
+                return attributes[i]->value.GetStr();
+            }
+        }
+        return nullptr;
+    }
+
+    int XMLStreamReader::Depth() const
+    {
+        // El cierre se informa con la profundidad del elemento que se cierra
+        const int depth = static_cast<int>(openElements.size());
+        return current == StreamEvent::EndElement ? depth + 1 : depth;
+    }
+
+    int XMLStreamReader::LineNum() const
+    {
+        return lineNum;
+    }
+
+    std::uint64_t XMLStreamReader::BytesRead() const
+    {
+        return bytesRead;
+    }
+}
@@ -0,0 +1,819 @@
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <QElapsedTimer>
+
+#include "../headers/XMLTreeModel.hpp"
+
+XMLTreeModel::XMLTreeModel(QObject* parent) : QAbstractItemModel(parent)
+{
+    // Intervalo 0: un trozo por vuelta del bucle de eventos, después de pintar y atender al usuario
+    populateTimer = new QTimer(this);
+    populateTimer->setInterval(0);
+    connect(populateTimer, &QTimer::timeout, this, &XMLTreeModel::PopulateStep);
+}
+
+XMLTreeModel::~XMLTreeModel() { }
+
+void XMLTreeModel::SetDocuments(const std::vector<xmlEditor::XMLEditor*>& newDocuments, const QString& newProjectName,
+    const QStringList& newDocumentPaths)
+{
+    beginResetModel();
+    documents = newDocuments;
+    projectName = newProjectName;
+    documentPaths = newDocumentPaths;
+    filtered = false;
+    filterElements.clear();
+    filterPath.clear();
+    ClearRows();
+    endResetModel();
+    PopulateDocuments();
+}
+
+void XMLTreeModel::Clear()
+{
+    SetDocuments(std::vector<xmlEditor::XMLEditor*>());
+}
+
+void XMLTreeModel::Reload()
+{
+    beginResetModel();
+    ClearRows();
+    endResetModel();
+    PopulateDocuments();
+}
+
+void XMLTreeModel::SetFilter(const std::vector<tinyxml2::XMLElement*>& elements)
+{
+    beginResetModel();
+    filtered = true;
+    filterElements.clear();
+    filterPath.clear();
+    filterElements.insert(elements.begin(), elements.end());
+    for (const tinyxml2::XMLElement* element : elements)
+    {
+        // Se sube hasta encontrar un padre que ya está en el camino de otro elemento
+        for (const tinyxml2::XMLNode* parent = element->Parent(); parent != nullptr && parent->ToElement() != nullptr; parent = parent->Parent())
+        {
+            if (!filterPath.insert(parent->ToElement()).second)
+            {
+                break;
+            }
+        }
+    }
+    ClearRows();
+    endResetModel();
+    PopulateDocuments();
+}
+
+void XMLTreeModel::ClearFilter()
+{
+    if (!filtered)
+    {
+        return;
+    }
+    beginResetModel();
+    filtered = false;
+    filterElements.clear();
+    filterPath.clear();
+    ClearRows();
+    endResetModel();
+    PopulateDocuments();
+}
+
+bool XMLTreeModel::IsFiltered() const
+{
+    return filtered;
+}
+
+bool XMLTreeModel::ShowsAllChildren(const tinyxml2::XMLElement* element) const
+{
+    if (!filtered)
+    {
+        return true;
+    }
+    for (const tinyxml2::XMLNode* current = element; current != nullptr && current->ToElement() != nullptr; current = current->Parent())
+    {
+        if (filterElements.count(current->ToElement()) > 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void XMLTreeModel::PopulateDocuments()
+{
+    // Los capítulos de cada documento llegan poco a poco, empezando por los primeros
+    for (xmlEditor::XMLEditor* document : documents)
+    {
+        PopulateInBackground(IndexOfElement(document->GetRootNode()));
+    }
+}
+
+void XMLTreeModel::ClearRows()
+{
+    rows.clear();
+    positions.clear();
+    populateQueue.clear();
+    populateTimer->stop();
+    for (std::size_t i = 0; i < documents.size(); i++)
+    {
+        positions[documents[i]->GetRootNode()] = i;
+    }
+}
+
+bool XMLTreeModel::IsProjectMode() const
+{
+    return !projectName.isEmpty();
+}
+
+XMLTreeModel::Rows& XMLTreeModel::RowsOf(tinyxml2::XMLElement* element) const
+{
+    std::unique_ptr<Rows>& cached = rows[element];
+    if (!cached)
+    {
+        cached = std::make_unique<Rows>();
+        cached->deferred = element->IsDeferred();
+
+        // Solo la primera tanda de hijos; el resto la pide la vista con fetchMore
+        AppendElements(element, *cached, FetchBatchSize);
+    }
+    return *cached;
+}
+
+std::vector<tinyxml2::XMLElement*> XMLTreeModel::NextElements(tinyxml2::XMLElement* element, const Rows& elementRows, std::size_t count) const
+{
+    // Se sigue desde el último hijo con fila, así no hace falta guardar dónde se quedó la tanda anterior
+    std::vector<tinyxml2::XMLElement*> batch;
+    tinyxml2::XMLElement* child = elementRows.elements.empty() ? element->FirstChildElement() : elementRows.elements.back()->NextSiblingElement();
+    const bool showAll = ShowsAllChildren(element);
+    for (; child != nullptr && batch.size() < count; child = child->NextSiblingElement())
+    {
+        // Con filtro se saltan los hijos que no llevan a ningún elemento filtrado
+        if (showAll || filterPath.count(child) > 0 || filterElements.count(child) > 0)
+        {
+            batch.push_back(child);
+        }
+    }
+    return batch;
+}
+
+void XMLTreeModel::AppendElements(tinyxml2::XMLElement* element, Rows& elementRows, std::size_t count) const
+{
+    const std::vector<tinyxml2::XMLElement*> batch = NextElements(element, elementRows, count);
+    const std::size_t first = elementRows.elements.size();
+    elementRows.elements.insert(elementRows.elements.end(), batch.begin(), batch.end());
+    IndexPositions(elementRows, first);
+    elementRows.pending = !NextElements(element, elementRows, 1).empty();
+}
+
+void XMLTreeModel::FetchElements(const QModelIndex& parent, tinyxml2::XMLElement* element, Rows& elementRows, std::size_t count)
+{
+    const std::size_t available = NextElements(element, elementRows, count).size();
+    if (available == 0)
+    {
+        elementRows.pending = false;
+        return;
+    }
+    const int first = static_cast<int>(elementRows.elements.size());
+    beginInsertRows(parent, first, first + static_cast<int>(available) - 1);
+    AppendElements(element, elementRows, count);
+    endInsertRows();
+}
+
+void XMLTreeModel::IndexPositions(const Rows& elementRows, std::size_t first) const
+{
+    for (std::size_t i = first; i < elementRows.elements.size(); i++)
+    {
+        positions[elementRows.elements[i]] = i;
+    }
+}
+
+tinyxml2::XMLElement* XMLTreeModel::ParentElementOf(const QModelIndex& index) const
+{
+    void* pointer = index.internalPointer();
+    if (pointer == nullptr || pointer == this)
+    {
+        return nullptr;
+    }
+    return static_cast<tinyxml2::XMLElement*>(pointer);
+}
+
+bool XMLTreeModel::IsDocumentRow(const QModelIndex& index) const
+{
+    // Nodo raíz de un documento: fila superior sin proyecto o hija de la raíz del proyecto
+    return index.internalPointer() == (IsProjectMode() ? this : nullptr);
+}
+
+XMLTreeModel::RowKind XMLTreeModel::KindOf(const QModelIndex& index) const
+{
+    if (IsProjectMode() && index.internalPointer() == nullptr)
+    {
+        return RowKind::Project;
+    }
+    tinyxml2::XMLElement* parentElement = ParentElementOf(index);
+    if (parentElement == nullptr)
+    {
+        return RowKind::Element;
+    }
+
+    // La fila provisional va después de todos los elementos
+    const Rows& parentRows = RowsOf(parentElement);
+    return index.row() < static_cast<int>(parentRows.elements.size()) ? RowKind::Element : RowKind::Deferred;
+}
+
+tinyxml2::XMLElement* XMLTreeModel::ElementAt(const QModelIndex& index) const
+{
+    if (!index.isValid() || KindOf(index) != RowKind::Element)
+    {
+        return nullptr;
+    }
+    if (IsDocumentRow(index))
+    {
+        return documents[index.row()]->GetRootNode();
+    }
+    const Rows& parentRows = RowsOf(ParentElementOf(index));
+    return parentRows.elements[index.row()];
+}
+
+xmlEditor::XMLEditor* XMLTreeModel::DocumentOf(const tinyxml2::XMLElement* element) const
+{
+    for (xmlEditor::XMLEditor* document : documents)
+    {
+        if (document->Contains(element))
+        {
+            return document;
+        }
+    }
+    return nullptr;
+}
+
+QModelIndex XMLTreeModel::IndexOfElement(tinyxml2::XMLElement* element) const
+{
+    if (element == nullptr)
+    {
+        return QModelIndex();
+    }
+    tinyxml2::XMLElement* parentElement = element->Parent() ? element->Parent()->ToElement() : nullptr;
+    if (parentElement == nullptr)
+    {
+        // Nodo raíz de un documento
+        const auto position = positions.find(element);
+        if (position == positions.end())
+        {
+            return QModelIndex();
+        }
+        return createIndex(static_cast<int>(position->second), 0, IsProjectMode() ? const_cast<XMLTreeModel*>(this) : nullptr);
+    }
+
+    // Leer las filas del padre guarda también la posición de sus hijos; si el elemento aún no
+    // tiene fila se añaden tandas hasta llegar a él
+    Rows& parentRows = RowsOf(parentElement);
+    if (parentRows.pending && positions.find(element) == positions.end())
+    {
+        const QModelIndex parentIndex = IndexOfElement(parentElement);
+        XMLTreeModel* model = const_cast<XMLTreeModel*>(this);
+        while (parentRows.pending && positions.find(element) == positions.end())
+        {
+            model->FetchElements(parentIndex, parentElement, parentRows, FetchBatchSize);
+        }
+    }
+    const auto position = positions.find(element);
+    if (position == positions.end() || position->second >= parentRows.elements.size()
+        || parentRows.elements[position->second] != element)
+    {
+        return QModelIndex();
+    }
+    return createIndex(static_cast<int>(position->second), 0, parentElement);
+}
+
+QModelIndex XMLTreeModel::RevealElement(tinyxml2::XMLElement* element)
+{
+    // Se baja desde la raíz para que cada padre tenga sus filas antes de buscar al hijo
+    std::vector<tinyxml2::XMLElement*> path;
+    for (tinyxml2::XMLElement* current = element; current != nullptr; current = current->Parent() ? current->Parent()->ToElement() : nullptr)
+    {
+        path.push_back(current);
+    }
+    QModelIndex index;
+    for (auto current = path.rbegin(); current != path.rend(); ++current)
+    {
+        index = IndexOfElement(*current);
+        if (!index.isValid())
+        {
+            return QModelIndex();
+        }
+
+        // Los capítulos del camino se leen; si el documento ya los leyó (al buscar o al guardar)
+        // solo se quita su fila provisional
+        if (*current != element && RowsOf(*current).deferred)
+        {
+            ExpandDeferred(index);
+        }
+    }
+    return index;
+}
+
+QModelIndex XMLTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (row < 0 || column < 0 || column >= columnCount(parent) || row >= rowCount(parent))
+    {
+        return QModelIndex();
+    }
+    if (!parent.isValid())
+    {
+        return createIndex(row, column, nullptr);
+    }
+    if (KindOf(parent) == RowKind::Project)
+    {
+        return createIndex(row, column, const_cast<XMLTreeModel*>(this));
+    }
+    return createIndex(row, column, ElementAt(parent));
+}
+
+QModelIndex XMLTreeModel::parent(const QModelIndex& index) const
+{
+    if (!index.isValid() || index.internalPointer() == nullptr)
+    {
+        return QModelIndex();
+    }
+    if (index.internalPointer() == this)
+    {
+        // Los archivos cuelgan de la raíz del proyecto
+        return createIndex(0, 0, nullptr);
+    }
+    return IndexOfElement(ParentElementOf(index));
+}
+
+int XMLTreeModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.column() > 0)
+    {
+        return 0;
+    }
+    if (!parent.isValid())
+    {
+        if (IsProjectMode())
+        {
+            return 1;
+        }
+        return documents.empty() || documents[0]->GetRootNode() == nullptr ? 0 : 1;
+    }
+    if (KindOf(parent) == RowKind::Project)
+    {
+        return static_cast<int>(documents.size());
+    }
+    tinyxml2::XMLElement* element = ElementAt(parent);
+    return element ? RowsOf(element).Count() : 0;
+}
+
+int XMLTreeModel::columnCount(const QModelIndex&) const
+{
+    return ColumnCount;
+}
+
+bool XMLTreeModel::hasChildren(const QModelIndex& parent) const
+{
+    if (!parent.isValid() || KindOf(parent) == RowKind::Project)
+    {
+        return rowCount(parent) > 0;
+    }
+    if (parent.column() > 0)
+    {
+        return false;
+    }
+
+    // Sin leer las filas, para que pintar una fila no cueste más que la propia fila
+    const tinyxml2::XMLElement* element = ElementAt(parent);
+    if (element != nullptr && !ShowsAllChildren(element))
+    {
+        return filterPath.count(element) > 0;
+    }
+    return element != nullptr && (element->FirstChildElement() != nullptr || element->IsDeferred());
+}
+
+bool XMLTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+    if (!parent.isValid() || parent.column() > 0 || KindOf(parent) != RowKind::Element)
+    {
+        return false;
+    }
+    return RowsOf(ElementAt(parent)).pending;
+}
+
+void XMLTreeModel::fetchMore(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent))
+    {
+        return;
+    }
+    tinyxml2::XMLElement* element = ElementAt(parent);
+    FetchElements(parent, element, RowsOf(element), FetchBatchSize);
+}
+
+void XMLTreeModel::PopulateInBackground(const QModelIndex& parent)
+{
+    if (!canFetchMore(parent))
+    {
+        return;
+    }
+    populateQueue.push_back(QPersistentModelIndex(parent.siblingAtColumn(NameColumn)));
+    populateTimer->start();
+}
+
+void XMLTreeModel::PopulateStep()
+{
+    QElapsedTimer elapsed;
+    elapsed.start();
+    while (!populateQueue.empty() && elapsed.elapsed() < PopulateSliceMilliseconds)
+    {
+        // Un nodo borrado deja su fila persistente inválida y se salta
+        const QModelIndex parent = populateQueue.front();
+        if (!parent.isValid() || !canFetchMore(parent))
+        {
+            populateQueue.pop_front();
+            continue;
+        }
+        fetchMore(parent);
+    }
+    if (populateQueue.empty())
+    {
+        populateTimer->stop();
+    }
+}
+
+QString XMLTreeModel::ToQString(const char* text)
+{
+    return QString::fromUtf8(text ? text : "");
+}
+
+namespace
+{
+    // Nombres de atributo de cada columna, por orden de preferencia
+    const char* const SceneIdAttributes[] = { "numero", "number", "id", "capitulo" };
+    const char* const TitleAttributes[] = { "titulo", "title", "texto", "nombre", "name" };
+
+    template <std::size_t Count>
+    const tinyxml2::XMLAttribute* FindNamedAttribute(const tinyxml2::XMLElement* element, const char* const (&names)[Count])
+    {
+        for (const char* name : names)
+        {
+            if (const tinyxml2::XMLAttribute* attribute = element->FindAttribute(name))
+            {
+                return attribute;
+            }
+        }
+        return nullptr;
+    }
+}
+
+const tinyxml2::XMLAttribute* XMLTreeModel::ColumnAttribute(const tinyxml2::XMLElement* element, int column)
+{
+    if (element == nullptr || (column != SceneIdColumn && column != TitleColumn))
+    {
+        return nullptr;
+    }
+    const tinyxml2::XMLAttribute* sceneId = FindNamedAttribute(element, SceneIdAttributes);
+    const tinyxml2::XMLAttribute* title = FindNamedAttribute(element, TitleAttributes);
+
+    // Los atributos con otros nombres ocupan las columnas que queden libres, en orden
+    for (const tinyxml2::XMLAttribute* attribute = element->FirstAttribute(); attribute && (!sceneId || !title); attribute = attribute->Next())
+    {
+        if (attribute == sceneId || attribute == title)
+        {
+            continue;
+        }
+        if (!sceneId)
+        {
+            sceneId = attribute;
+        }
+        else
+        {
+            title = attribute;
+        }
+    }
+    return column == SceneIdColumn ? sceneId : title;
+}
+
+QString XMLTreeModel::OtherAttributes(const tinyxml2::XMLElement* element)
+{
+    const tinyxml2::XMLAttribute* sceneId = ColumnAttribute(element, SceneIdColumn);
+    const tinyxml2::XMLAttribute* title = ColumnAttribute(element, TitleColumn);
+    QStringList lines;
+    for (const tinyxml2::XMLAttribute* attribute = element->FirstAttribute(); attribute; attribute = attribute->Next())
+    {
+        if (attribute != sceneId && attribute != title)
+        {
+            lines << ToQString(attribute->Name()) + " : " + ToQString(attribute->Value());
+        }
+    }
+    return lines.join("\n");
+}
+
+QVariant XMLTreeModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid())
+    {
+        return QVariant();
+    }
+    if (role != Qt::DisplayRole && role != Qt::EditRole && role != Qt::ToolTipRole)
+    {
+        return QVariant();
+    }
+
+    const RowKind kind = KindOf(index);
+    if (kind != RowKind::Element)
+    {
+        if (index.column() != NameColumn || role == Qt::ToolTipRole)
+        {
+            return QVariant();
+        }
+        return kind == RowKind::Project ? projectName : QStringLiteral("...");
+    }
+
+    const tinyxml2::XMLElement* element = ElementAt(index);
+    if (role == Qt::ToolTipRole)
+    {
+        switch (index.column())
+        {
+        case NameColumn:
+        {
+            // Ruta del archivo en las filas de los documentos de un proyecto y atributos sin columna
+            QString toolTip = OtherAttributes(element);
+            if (IsProjectMode() && IsDocumentRow(index) && index.row() < documentPaths.size())
+            {
+                toolTip = toolTip.isEmpty() ? documentPaths[index.row()] : documentPaths[index.row()] + "\n" + toolTip;
+            }
+            return toolTip.isEmpty() ? QVariant() : QVariant(toolTip);
+        }
+        case SceneIdColumn:
+        case TitleColumn:
+        {
+            // Nombre del atributo que se muestra en la celda
+            const tinyxml2::XMLAttribute* attribute = ColumnAttribute(element, index.column());
+            return attribute ? QVariant(ToQString(attribute->Name())) : QVariant();
+        }
+        }
+        return QVariant();
+    }
+
+    switch (index.column())
+    {
+    case NameColumn:
+        return ToQString(element->Name());
+    case SceneIdColumn:
+    case TitleColumn:
+    {
+        const tinyxml2::XMLAttribute* attribute = ColumnAttribute(element, index.column());
+        return attribute ? ToQString(attribute->Value()) : QString();
+    }
+    case ContentColumn:
+        return ToQString(element->GetText());
+    }
+    return QVariant();
+}
+
+bool XMLTreeModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    if (!index.isValid() || role != Qt::EditRole || !(flags(index) & Qt::ItemIsEditable))
+    {
+        return false;
+    }
+
+    // Los cambios se escriben en el documento en el momento, en el atributo de la columna
+    tinyxml2::XMLElement* element = ElementAt(index);
+    const QString text = value.toString();
+    switch (index.column())
+    {
+    case NameColumn:
+    {
+        if (text.trimmed().isEmpty())
+        {
+            return false;
+        }
+        DocumentOf(element)->RenameNode(element, text.trimmed().toStdString());
+        break;
+    }
+    case SceneIdColumn:
+    case TitleColumn:
+    {
+        const std::string attributeName = ColumnAttribute(element, index.column())->Name();
+        DocumentOf(element)->ModifyNodeAttribute(element, attributeName, text.toStdString());
+        break;
+    }
+    case ContentColumn:
+        DocumentOf(element)->ModifyNodeValue(element, text.toStdString());
+        break;
+    default:
+        return false;
+    }
+
+    emit dataChanged(index, index);
+    emit DocumentEdited();
+    return true;
+}
+
+Qt::ItemFlags XMLTreeModel::flags(const QModelIndex& index) const
+{
+    if (!index.isValid())
+    {
+        return Qt::NoItemFlags;
+    }
+    const Qt::ItemFlags flags = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    if (KindOf(index) != RowKind::Element)
+    {
+        return flags;
+    }
+
+    const tinyxml2::XMLElement* element = ElementAt(index);
+    switch (index.column())
+    {
+    case SceneIdColumn:
+    case TitleColumn:
+        // Solo si hay un atributo que mostrar; la celda vacía no sabe qué atributo crear
+        return ColumnAttribute(element, index.column()) ? flags | Qt::ItemIsEditable : flags;
+    case ContentColumn:
+    {
+        // El texto de un nodo con hijos solo se edita si ya tiene uno
+        const char* text = element->GetText();
+        const bool hasText = text != nullptr && *text != 0;
+        return hasText || (element->FirstChildElement() == nullptr && !element->IsDeferred()) ? flags | Qt::ItemIsEditable : flags;
+    }
+    }
+    return flags | Qt::ItemIsEditable;
+}
+
+QVariant XMLTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    {
+        return QVariant();
+    }
+    switch (section)
+    {
+    case NameColumn:
+        return tr("Node");
+    case SceneIdColumn:
+        return tr("Scene ID");
+    case TitleColumn:
+        return tr("Title");
+    case ContentColumn:
+        return tr("Content");
+    }
+    return QVariant();
+}
+
+void XMLTreeModel::ExpandDeferred(const QModelIndex& index)
+{
+    tinyxml2::XMLElement* element = ElementAt(index);
+    if (element == nullptr)
+    {
+        return;
+    }
+    Rows& elementRows = RowsOf(element);
+    if (!elementRows.deferred)
+    {
+        return;
+    }
+
+    // Se quita la fila provisional y se lee el contenido del capítulo
+    const int placeholderRow = elementRows.Count() - 1;
+    beginRemoveRows(index, placeholderRow, placeholderRow);
+    elementRows.deferred = false;
+    endRemoveRows();
+
+    DocumentOf(element)->ExpandNode(element);
+
+    // El texto del capítulo ya se puede mostrar en su columna
+    const QModelIndex contentIndex = createIndex(index.row(), ContentColumn, index.internalPointer());
+    emit dataChanged(contentIndex, contentIndex);
+
+    // Primera tanda de hijos; el resto con fetchMore
+    FetchElements(index, element, elementRows, FetchBatchSize);
+}
+
+void XMLTreeModel::ForgetRows(const tinyxml2::XMLElement* element)
+{
+    // Los elementos borrados pueden dejar su dirección a otros nuevos; sus filas no deben quedar guardadas
+    for (xmlEditor::ConstElementCursor cursor(element); cursor; cursor.Next())
+    {
+        const tinyxml2::XMLElement* current = cursor.Current();
+        rows.erase(current);
+        positions.erase(current);
+        filterElements.erase(current);
+        filterPath.erase(current);
+    }
+}
+
+QModelIndex XMLTreeModel::AddElement(tinyxml2::XMLElement* parentElement, const std::string& name)
+{
+    const QModelIndex parentIndex = IndexOfElement(parentElement);
+    if (!parentIndex.isValid())
+    {
+        // Lanza un aviso si el padre no se muestra en el árbol
+        throw std::invalid_argument("Parent node is not in the tree");
+    }
+
+    // Un capítulo sin leer se lee antes, como hace AddChildNode, para que sus filas sigan cuadrando
+    Rows& parentRows = RowsOf(parentElement);
+    if (parentRows.deferred)
+    {
+        ExpandDeferred(parentIndex);
+    }
+
+    // El nuevo elemento va al final, así que antes se añaden los hermanos que falten
+    if (parentRows.pending)
+    {
+        FetchElements(parentIndex, parentElement, parentRows, std::numeric_limits<std::size_t>::max());
+    }
+
+    tinyxml2::XMLElement* newElement = DocumentOf(parentElement)->AddChildNode(parentElement, name);
+    if (filtered)
+    {
+        // El nuevo elemento se sigue viendo con el filtro puesto
+        filterElements.insert(newElement);
+    }
+    const int row = static_cast<int>(parentRows.elements.size());
+    beginInsertRows(parentIndex, row, row);
+    positions[newElement] = parentRows.elements.size();
+    parentRows.elements.push_back(newElement);
+    endInsertRows();
+    return createIndex(row, 0, parentElement);
+}
+
+QModelIndex XMLTreeModel::RemoveElement(tinyxml2::XMLElement* element)
+{
+    tinyxml2::XMLElement* parentElement = element && element->Parent() ? element->Parent()->ToElement() : nullptr;
+    if (parentElement == nullptr)
+    {
+        // Lanza un aviso si se intenta quitar el nodo raíz
+        throw std::invalid_argument("Root node cannot be removed");
+    }
+    const QModelIndex index = IndexOfElement(element);
+    const QModelIndex parentIndex = IndexOfElement(parentElement);
+    if (!index.isValid() || !parentIndex.isValid())
+    {
+        throw std::invalid_argument("Node is not in the tree");
+    }
+
+    Rows& parentRows = RowsOf(parentElement);
+    const std::size_t position = static_cast<std::size_t>(index.row());
+    beginRemoveRows(parentIndex, index.row(), index.row());
+    parentRows.elements.erase(parentRows.elements.begin() + position);
+    IndexPositions(parentRows, position);
+    ForgetRows(element);
+    DocumentOf(parentElement)->RemoveChildNode(parentElement, element);
+    endRemoveRows();
+
+    // Si el elemento quitado iba delante de un texto, ese texto pasa a ser el del padre
+    const QModelIndex contentIndex = createIndex(parentIndex.row(), ContentColumn, parentIndex.internalPointer());
+    emit dataChanged(contentIndex, contentIndex);
+    return parentIndex;
+}
+
+void XMLTreeModel::RefreshElements(const std::vector<tinyxml2::XMLElement*>& elements)
+{
+    // Una sola señal por padre, de la primera a la última fila que ha cambiado
+    std::unordered_map<void*, std::pair<std::size_t, std::size_t>> changed;
+    for (tinyxml2::XMLElement* element : elements)
+    {
+        const auto position = positions.find(element);
+        if (position == positions.end())
+        {
+            continue;
+        }
+        tinyxml2::XMLElement* parentElement = element->Parent() ? element->Parent()->ToElement() : nullptr;
+        void* parentPointer = parentElement;
+        if (parentElement == nullptr)
+        {
+            // Nodo raíz de un documento
+            parentPointer = IsProjectMode() ? this : nullptr;
+        }
+        else
+        {
+            const auto parentRows = rows.find(parentElement);
+            if (parentRows == rows.end() || position->second >= parentRows->second->elements.size()
+                || parentRows->second->elements[position->second] != element)
+            {
+                continue;
+            }
+        }
+        const auto range = changed.emplace(parentPointer, std::make_pair(position->second, position->second));
+        range.first->second.first = std::min(range.first->second.first, position->second);
+        range.first->second.second = std::max(range.first->second.second, position->second);
+    }
+    for (const auto& range : changed)
+    {
+        emit dataChanged(createIndex(static_cast<int>(range.second.first), 0, range.first),
+            createIndex(static_cast<int>(range.second.second), ColumnCount - 1, range.first));
+    }
+
+    // También si ninguna fila estaba leída: el documento ha cambiado igual
+    emit DocumentEdited();
+}
@@ -1,302 +1,1067 @@
-// Autor: felixhmy 
-// Todos los derechos reservados © 2025 
-
-#include "../headers/XMLsEditorInteractiveNovels.hpp"
-
-XMLsEditorInteractiveNovels::XMLsEditorInteractiveNovels() : QMainWindow(nullptr)
-{
-    ui.setupUi(this);
-
-    model = new QStandardItemModel(0, 3, this);
-    model->setHorizontalHeaderLabels(QStringList() << "Scene ID" << "Title" << "Content");
-
-    // Botones del menu
-    connect(ui.NewFileMenu, &QAction::triggered, this, &XMLsEditorInteractiveNovels::New);
-    connect(ui.LoadFileMenu, &QAction::triggered, this, &XMLsEditorInteractiveNovels::Load);
-    connect(ui.SaveFileMenu, &QAction::triggered, this, &XMLsEditorInteractiveNovels::Save);
-    // Botones laterales
-    connect(ui.AddNodeButton, &QPushButton::clicked, this, &XMLsEditorInteractiveNovels::AddNode);
-    connect(ui.RemoveNodeButton, &QPushButton::clicked, this, &XMLsEditorInteractiveNovels::QuitNode);
-
-    ui.treeView->setModel(model);
-    ui.treeView->setSelectionMode(QAbstractItemView::SingleSelection);
-    ui.treeView->model(), &QStandardItemModel::itemChanged, this, &XMLsEditorInteractiveNovels::UpdateXmlNode;
-
-}
-
-void XMLsEditorInteractiveNovels::New()
-{
-    // Cargamos la plantilla base para un nuevo archivo XML.
-    std::string filePath = "../binaries/Base.xml";
-    try {
-        xmlEditorInstance.OpenFile(filePath);
-        QMessageBox::information(this, "New File", "File template loaded. Please use the Save option to save the file once completed.");
-
-        // Se carga en el árbol
-        model->clear(); // limpia el model antes de llenarlo
-        tinyxml2::XMLElement* root = xmlEditorInstance.GetRootNode();
-        QStandardItem* rootItem = new QStandardItem(QString::fromStdString(root->Name()));
-        model->appendRow(rootItem);
-        buildTree(root, rootItem);
-    }
-    catch (std::runtime_error& e) {
-        // Mostrar mensaje de error si no se puede abrir el archivo
-        QMessageBox::critical(this, "Error", "Failed to load new file template. Check the file path and try again.");
-    }
-}
-
-void XMLsEditorInteractiveNovels::Load()
-{
-    QString qFilePath = QFileDialog::getOpenFileName(this, tr("Open XML File"), "", tr("XML Files (*.xml)"));
-    if (qFilePath.isEmpty()) {
-        return;
-    }
-
-    std::string filePath = qFilePath.toStdString();
-    try {
-        xmlEditorInstance.OpenFile(filePath);
-
-        // Se carga en el árbol
-        model->clear(); // limpia el model antes de llenarlo
-        tinyxml2::XMLElement* root = xmlEditorInstance.GetRootNode();
-        QStandardItem* rootItem = new QStandardItem(QString::fromStdString(root->Name()));
-        model->appendRow(rootItem);
-        buildTree(root, rootItem);
-    }
-    catch (std::runtime_error& e) {
-        // Mostrar mensaje de error si no se puede cargar el archivo
-        QMessageBox::critical(this, "Error", "Failed to load XML file. Please check the file and try again.");
-    }
-}
-
-void XMLsEditorInteractiveNovels::Save()
-{
-    // Solicitar al usuario la ruta del nuevo archivo
-    QString qFilePath = QFileDialog::getSaveFileName(this, tr("Save XML File As"), "", tr("XML Files (*.xml)"));
-    if (qFilePath.isEmpty()) {
-        return;
-    }
-
-    std::string filePath = qFilePath.toStdString();
-
-    // Actualizar la estructura XML en memoria según los cambios en la vista de árbol
-    QModelIndex rootIndex = model->index(0, 0);
-    UpdateXmlNode(xmlEditorInstance.GetRootNode(), model->itemFromIndex(rootIndex));
-
-    // Guardar el archivo XML actualizado
-    xmlEditorInstance.SaveFile(filePath);
-
-    QMessageBox::information(this, "Save File", "File saved successfully.");
-}
-
-void XMLsEditorInteractiveNovels::AddNode()
-{
-    // Primero, obten el elemento seleccionado en el árbol
-    QModelIndex currentIndex = ui.treeView->currentIndex();
-    QStandardItem* currentItem = model->itemFromIndex(currentIndex);
-
-    if (currentItem == nullptr)
-    {
-        // No se seleccionó ningún elemento
-        QMessageBox::information(this, tr("Error"), tr("No node selected."));
-        return;
-    }
-
-    // Aquí se usa findNode para encontrar el nodo XML correspondiente
-    tinyxml2::XMLElement* currentXMLNode = findNode(currentItem->text().toStdString(), xmlEditorInstance.GetRootNode());
-
-    if (currentXMLNode == nullptr)
-    {
-        // No se encontró el nodo correspondiente en el XML
-        QMessageBox::information(this, tr("Error"), tr("No corresponding XML node found."));
-        return;
-    }
-
-    bool ok;
-    QString nodeName = QInputDialog::getText(this, tr("Add Node"), tr("Node name:"), QLineEdit::Normal, "nodeName", &ok);
-    if (ok && !nodeName.isEmpty())
-    {
-        QString nodeAttribute = QInputDialog::getText(this, tr("Add Node Attribute"), tr("Node attribute:"), QLineEdit::Normal, "attribute=value", &ok);
-        if (ok)
-        {
-            tinyxml2::XMLElement* newNode = xmlEditorInstance.AddChildNode(currentXMLNode, nodeName.toStdString());
-            QStringList attrList = nodeAttribute.split('=');
-            if (attrList.size() == 2)
-            {
-                xmlEditorInstance.ModifyNodeAttribute(newNode, attrList[0].toStdString(), attrList[1].toStdString());
-            }
-
-            // Actualiza la vista
-            model->clear();
-            tinyxml2::XMLElement* root = xmlEditorInstance.GetRootNode();
-            QStandardItem* rootItem = new QStandardItem(QString::fromStdString(root->Name()));
-            model->appendRow(rootItem);
-            buildTree(root, rootItem);
-
-            // Encontramos el nuevo elemento en el árbol y lo seleccionamos
-            QStandardItem* newItem = findItem(newNode, rootItem);
-            if (newItem)
-            {
-                ui.treeView->setCurrentIndex(newItem->index());
-            }
-        }
-    }
-}
-
-void XMLsEditorInteractiveNovels::QuitNode()
-{
-    // Primero, obten el elemento seleccionado en el árbol
-    QModelIndex currentIndex = ui.treeView->currentIndex();
-    QStandardItem* currentItem = model->itemFromIndex(currentIndex);
-
-    if (currentItem == nullptr)
-    {
-        // No se seleccionó ningún elemento
-        QMessageBox::information(this, tr("Error"), tr("No node selected."));
-        return;
-    }
-
-    // Aquí se usa findNode para encontrar el nodo XML correspondiente
-    tinyxml2::XMLElement* currentXMLNode = findNode(currentItem->text().toStdString(), xmlEditorInstance.GetRootNode());
-
-    if (currentXMLNode == nullptr)
-    {
-        // No se encontró el nodo correspondiente en el XML
-        QMessageBox::information(this, tr("Error"), tr("No corresponding XML node found."));
-        return;
-    }
-
-    // Comprobando si currentXMLNode y su padre no son nullptr antes de proceder
-    if (currentXMLNode->Parent())
-    {
-        tinyxml2::XMLElement* parentNode = currentXMLNode->Parent()->ToElement();
-        xmlEditorInstance.RemoveChildNode(parentNode, currentXMLNode);
-
-        // Actualizar el modelo de vista
-        model->clear();
-        tinyxml2::XMLElement* root = xmlEditorInstance.GetRootNode();
-        QStandardItem* rootItem = new QStandardItem(QString::fromStdString(root->Name()));
-        model->appendRow(rootItem);
-        buildTree(root, rootItem);
-
-        // Seleccionamos el elemento correspondiente al padre en el árbol
-        QStandardItem* newCurrentItem = findItem(parentNode, rootItem);
-        if (newCurrentItem)
-        {
-            ui.treeView->setCurrentIndex(newCurrentItem->index());
-        }
-    }
-    else
-    {
-        QMessageBox::information(this, tr("Error"), tr("Cannot remove root node."));
-    }
-}
-
-void XMLsEditorInteractiveNovels::buildTree(tinyxml2::XMLElement* rootNode, QStandardItem* parentItem)
-{
-    if (!rootNode || !parentItem) return;
-
-    for (tinyxml2::XMLElement* element = rootNode->FirstChildElement(); element != nullptr; element = element->NextSiblingElement())
-    {
-        QString elementName = QString::fromStdString(element->Name());
-        QString elementText = QString::fromStdString(element->GetText() ? element->GetText() : "");
-
-        QStandardItem* item = new QStandardItem(elementName);
-        parentItem->appendRow(item);
-
-        // Si hay texto dentro del nodo, lo agregamos como un hijo.
-        if (!elementText.isEmpty()) {
-            QStandardItem* textItem = new QStandardItem(elementText);
-            item->appendRow(textItem);
-        }
-
-        // Manejo de los atributos del nodo
-        for (const tinyxml2::XMLAttribute* attr = element->FirstAttribute(); attr; attr = attr->Next())
-        {
-            QString attrName = QString::fromStdString(attr->Name());
-            QString attrValue = QString::fromStdString(attr->Value());
-            QStandardItem* attrItem = new QStandardItem(attrName + " : " + attrValue);
-            item->appendRow(attrItem);
-        }
-
-        // Agrega elementos hijos
-        buildTree(element, item);
-    }
-}
-
-void XMLsEditorInteractiveNovels::UpdateXmlNode(tinyxml2::XMLElement* xmlElement, QStandardItem* item)
-{
-    // Actualizar el contenido del nodo XML según el elemento de la vista de árbol
-    QString itemName = item->text();
-
-    // Actualizar los atributos del nodo y buscar posibles subnodos para actualizar
-    QStandardItem* textItem = nullptr;
-    for (int i = 0; i < item->rowCount(); i++) {
-        QStandardItem* childItem = item->child(i);
-        QString childText = childItem->text();
-        QStringList attrList = childText.split(':');
-        if (attrList.size() == 2) {
-            // Este es un atributo
-            QString attrName = attrList[0].trimmed();
-            QString attrValue = attrList[1].trimmed();
-            xmlEditorInstance.ModifyNodeAttribute(xmlElement, attrName.toStdString(), attrValue.toStdString());
-        }
-        else if (childItem->rowCount() > 0) {
-            // Este es un subnodo
-            tinyxml2::XMLElement* childElement = xmlElement->FirstChildElement(childItem->text().toStdString().c_str());
-            if (childElement != nullptr) {
-                UpdateXmlNode(childElement, childItem);
-            }
-        }
-        else {
-            // Este es un texto de nodo
-            textItem = childItem;
-        }
-    }
-
-    if (textItem != nullptr) {
-        // Actualizar el texto del nodo
-        xmlElement->SetText(textItem->text().toStdString().c_str());
-    }
-}
-
-QStandardItem* XMLsEditorInteractiveNovels::findItem(tinyxml2::XMLElement* xmlElement, QStandardItem* parent)
-{
-    for (int i = 0; i < parent->rowCount(); i++)
-    {
-        QStandardItem* childItem = parent->child(i);
-        // Si el elemento tiene hijos, es probable que sea un nombre de nodo.
-        if (childItem->hasChildren() && childItem->text() == QString::fromStdString(xmlElement->Name()))
-        {
-            return childItem;
-        }
-
-        if (childItem->hasChildren())
-        {
-            QStandardItem* result = findItem(xmlElement, childItem);
-            if (result) return result;
-        }
-    }
-
-    return nullptr;
-}
-
-tinyxml2::XMLElement* XMLsEditorInteractiveNovels::findNode(const std::string& name, tinyxml2::XMLElement* parent)
-{
-    for (tinyxml2::XMLElement* child = parent->FirstChildElement(); child != nullptr; child = child->NextSiblingElement())
-    {
-        if (child->Name() == name)
-        {
-            return child;
-        }
-
-        if (child->FirstChildElement())
-        {
-            tinyxml2::XMLElement* result = findNode(name, child);
-            if (result) return result;
-        }
-    }
-
-    return nullptr;
-}
-
+// Autor: felixhmy 
+// Todos los derechos reservados © 2025 
+
+#include "../headers/XMLsEditorInteractiveNovels.hpp"
+
+namespace
+{
+    // Con más intervenciones que estas el filtro no despliega todo el árbol, solo la primera
+    constexpr std::size_t CharacterExpandLimit = 2000;
+
+    // Búsqueda mientras se escribe: espera desde la última tecla, tiempo máximo (un fotograma)
+    // y letras mínimas de la consulta
+    constexpr int LiveSearchDelay = 150;
+    constexpr std::chrono::milliseconds LiveSearchBudget(16);
+    constexpr int LiveSearchMinLength = 3;
+
+    // Coincidencias parecidas que se muestran como mucho
+    constexpr std::size_t SimilarResultLimit = 200;
+}
+
+XMLsEditorInteractiveNovels::XMLsEditorInteractiveNovels() : QMainWindow(nullptr),
+    xmlEditorInstance(std::make_unique<xmlEditor::XMLEditor>()),
+    loadThread(nullptr),
+    loadCancelled(false),
+    loadFailed(false),
+    indexThread(nullptr),
+    indexCancelled(false),
+    requestedChapter(nullptr),
+    indexFailed(false),
+    searchPosition(0),
+    liveResults(false)
+{
+    ui.setupUi(this);
+
+    // Progreso y cancelación de la carga en la barra de estado
+    loadProgressBar = new QProgressBar(this);
+    loadProgressBar->setRange(0, 100);
+    loadProgressBar->setMaximumWidth(200);
+    loadProgressBar->hide();
+    cancelLoadButton = new QPushButton(tr("Cancel"), this);
+    cancelLoadButton->hide();
+    ui.statusBar->addPermanentWidget(loadProgressBar);
+    ui.statusBar->addPermanentWidget(cancelLoadButton);
+    connect(cancelLoadButton, &QPushButton::clicked, this, &XMLsEditorInteractiveNovels::CancelLoad);
+
+    // Búsqueda en el texto de los nodos en la barra de herramientas
+    searchBox = new QLineEdit(this);
+    searchBox->setPlaceholderText(tr("Search text or names (word* for prefixes)"));
+    searchBox->setClearButtonEnabled(true);
+    searchBox->setMaximumWidth(300);
+    ui.mainToolBar->addWidget(searchBox);
+    connect(searchBox, &QLineEdit::returnPressed, this, &XMLsEditorInteractiveNovels::Search);
+    // Mientras se escribe se muestran las coincidencias parecidas al dejar de teclear
+    liveSearchTimer = new QTimer(this);
+    liveSearchTimer->setSingleShot(true);
+    liveSearchTimer->setInterval(LiveSearchDelay);
+    connect(liveSearchTimer, &QTimer::timeout, this, &XMLsEditorInteractiveNovels::LiveSearch);
+    connect(searchBox, &QLineEdit::textChanged, liveSearchTimer, qOverload<>(&QTimer::start));
+
+    // El árbol lee directamente el documento; los cambios en las celdas se escriben en él al momento
+    model = new XMLTreeModel(this);
+
+    // Panel de personajes a la derecha: al elegir uno el árbol muestra solo sus intervenciones
+    characterDock = new QDockWidget(tr("Characters"), this);
+    characterList = new QListWidget(characterDock);
+    characterDock->setWidget(characterList);
+    addDockWidget(Qt::RightDockWidgetArea, characterDock);
+    connect(characterList, &QListWidget::currentItemChanged, this, &XMLsEditorInteractiveNovels::FilterCharacter);
+    // Los cambios de texto o de nombre en las celdas cambian las cuentas; un reemplazo avisa de
+    // muchas filas a la vez y el panel se actualiza una sola vez al acabar. Desplegar un capítulo
+    // no lo actualiza: el reparto se cuenta al cargar.
+    characterRefreshTimer = new QTimer(this);
+    characterRefreshTimer->setSingleShot(true);
+    characterRefreshTimer->setInterval(0);
+    connect(characterRefreshTimer, &QTimer::timeout, this, &XMLsEditorInteractiveNovels::RefreshCharacters);
+    connect(characterRefreshTimer, &QTimer::timeout, this, &XMLsEditorInteractiveNovels::UpdateUndoReplace);
+    connect(model, &XMLTreeModel::DocumentEdited, characterRefreshTimer, qOverload<>(&QTimer::start));
+
+    // Reemplazar en todo el documento en la barra de herramientas
+    replaceAction = new QAction(tr("Replace..."), this);
+    replaceAction->setShortcut(QKeySequence::Replace);
+    undoReplaceAction = new QAction(tr("Undo replace"), this);
+    undoReplaceAction->setEnabled(false);
+    ui.mainToolBar->addAction(replaceAction);
+    ui.mainToolBar->addAction(undoReplaceAction);
+    // Deshacer solo vale para el reemplazo con el foco en el árbol, donde se ven sus cambios; en el
+    // cuadro de búsqueda y en otras ventanas sigue deshaciendo lo escrito
+    undoReplaceAction->setShortcut(QKeySequence::Undo);
+    undoReplaceAction->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    ui.treeView->addAction(undoReplaceAction);
+    connect(replaceAction, &QAction::triggered, this, &XMLsEditorInteractiveNovels::ReplaceAll);
+    connect(undoReplaceAction, &QAction::triggered, this, &XMLsEditorInteractiveNovels::UndoReplace);
+
+    // Botones del menu
+    connect(ui.NewFileMenu, &QAction::triggered, this, &XMLsEditorInteractiveNovels::New);
+    connect(ui.LoadFileMenu, &QAction::triggered, this, &XMLsEditorInteractiveNovels::Load);
+    connect(ui.LoadProjectMenu, &QAction::triggered, this, &XMLsEditorInteractiveNovels::LoadProject);
+    connect(ui.SaveFileMenu, &QAction::triggered, this, &XMLsEditorInteractiveNovels::Save);
+    // Botones laterales
+    connect(ui.AddNodeButton, &QPushButton::clicked, this, &XMLsEditorInteractiveNovels::AddNode);
+    connect(ui.RemoveNodeButton, &QPushButton::clicked, this, &XMLsEditorInteractiveNovels::QuitNode);
+    // Capítulos que se leen al desplegarlos
+    connect(ui.treeView, &QTreeView::expanded, this, &XMLsEditorInteractiveNovels::ExpandItem);
+
+    ui.treeView->setModel(model);
+    ui.treeView->setSelectionMode(QAbstractItemView::SingleSelection);
+    treeEditTriggers = ui.treeView->editTriggers();
+
+}
+
+XMLsEditorInteractiveNovels::~XMLsEditorInteractiveNovels()
+{
+    // No se puede cerrar la ventana con el hilo de carga o el del índice en marcha
+    if (loadThread)
+    {
+        loadCancelled = true;
+        loadThread->wait();
+    }
+    if (indexThread)
+    {
+        indexCancelled = true;
+        indexThread->wait();
+    }
+}
+
+void XMLsEditorInteractiveNovels::New()
+{
+    // Cargamos la plantilla base para un nuevo archivo XML.
+    std::string filePath = "../binaries/Base.xml";
+    try {
+        // El árbol deja de apuntar al documento antes de sustituirlo
+        model->Clear();
+        project.reset();
+        xmlEditorInstance->OpenFile(filePath);
+        QMessageBox::information(this, "New File", "File template loaded. Please use the Save option to save the file once completed.");
+
+        // Se carga en el árbol; si el documento anterior era de solo lectura, este ya se puede editar
+        RebuildTree();
+        LockEditing(false);
+        ui.statusBar->clearMessage();
+    }
+    catch (std::runtime_error& e) {
+        // Mostrar mensaje de error si no se puede abrir el archivo
+        QMessageBox::critical(this, "Error", "Failed to load new file template. Check the file path and try again.");
+    }
+}
+
+void XMLsEditorInteractiveNovels::Load()
+{
+    QString qFilePath = QFileDialog::getOpenFileName(this, tr("Open XML File"), "", tr("XML Files (*.xml)"));
+    if (qFilePath.isEmpty()) {
+        return;
+    }
+
+    StartLoad(qFilePath.toStdString());
+}
+
+void XMLsEditorInteractiveNovels::LoadProject()
+{
+    QString qDirectoryPath = QFileDialog::getExistingDirectory(this, tr("Open Project Folder"));
+    if (qDirectoryPath.isEmpty()) {
+        return;
+    }
+
+    StartLoad(qDirectoryPath.toStdString(), true);
+}
+
+void XMLsEditorInteractiveNovels::StartLoad(const std::string& filePath, bool projectMode)
+{
+    if (loadThread || indexThread)
+    {
+        // Ya hay una carga en curso
+        return;
+    }
+
+    // El archivo se lee en un documento nuevo; el actual se sigue pudiendo consultar
+    if (projectMode)
+    {
+        pendingProject = std::make_unique<xmlEditor::XMLProject>();
+    }
+    else
+    {
+        pendingEditor = std::make_unique<xmlEditor::XMLEditor>();
+    }
+    loadCancelled = false;
+    loadFailed = false;
+    loadError.clear();
+
+    ui.LoadFileMenu->setEnabled(false);
+    ui.LoadProjectMenu->setEnabled(false);
+    loadProgressBar->setFormat(QStringLiteral("%p%"));
+    loadProgressBar->setValue(0);
+    loadProgressBar->show();
+    cancelLoadButton->show();
+    ui.statusBar->showMessage(tr("Loading %1...").arg(QString::fromStdString(filePath)));
+
+    xmlEditor::XMLEditor* editor = pendingEditor.get();
+    xmlEditor::XMLProject* projectLoad = pendingProject.get();
+    loadThread = QThread::create([this, editor, projectLoad, filePath]() {
+        // Solo se leen los capítulos; su contenido se lee después, con el índice de palabras
+        // (StartTextIndex), o al desplegarlos. En un proyecto los hilos leen varios archivos a la vez.
+        xmlEditor::LoadOptions options;
+        options.lazyChapters = true;
+        options.parseThreads = 0;
+        int lastPercent = -1;
+        options.progress = [this, &lastPercent](std::size_t parsedBytes, std::size_t totalBytes) {
+            int percent = totalBytes > 0 ? static_cast<int>(parsedBytes * 100 / totalBytes) : 0;
+            if (percent != lastPercent)
+            {
+                lastPercent = percent;
+                QMetaObject::invokeMethod(loadProgressBar, "setValue", Qt::QueuedConnection, Q_ARG(int, percent));
+            }
+            return !loadCancelled;
+        };
+
+        try {
+            if (projectLoad)
+            {
+                projectLoad->Open(filePath, options);
+            }
+            else
+            {
+                editor->OpenFile(filePath, options);
+            }
+        }
+        catch (std::runtime_error& e) {
+            loadFailed = true;
+            loadError = e.what();
+        }
+    });
+    connect(loadThread, &QThread::finished, this, &XMLsEditorInteractiveNovels::FinishLoad);
+    loadThread->start();
+}
+
+void XMLsEditorInteractiveNovels::CancelLoad()
+{
+    if (indexThread)
+    {
+        indexCancelled = true;
+    }
+    else
+    {
+        loadCancelled = true;
+    }
+    ui.statusBar->showMessage(tr("Cancelling..."));
+}
+
+void XMLsEditorInteractiveNovels::FinishLoad()
+{
+    loadThread->deleteLater();
+    loadThread = nullptr;
+    loadProgressBar->hide();
+    cancelLoadButton->hide();
+    ui.LoadFileMenu->setEnabled(true);
+    ui.LoadProjectMenu->setEnabled(true);
+
+    if (loadCancelled || loadFailed)
+    {
+        // Se descarta el documento a medias y se conserva el que ya estaba abierto
+        pendingEditor.reset();
+        pendingProject.reset();
+        if (loadCancelled)
+        {
+            ui.statusBar->showMessage(tr("Loading cancelled."), 5000);
+        }
+        else
+        {
+            // Mostrar mensaje de error si no se puede cargar el archivo
+            ui.statusBar->clearMessage();
+            QMessageBox::critical(this, "Error", "Failed to load XML file. Please check the file and try again.\n" + QString::fromStdString(loadError));
+        }
+        return;
+    }
+
+    // Cambia al documento nuevo de una vez; el anterior se libera al terminar
+    std::unique_ptr<xmlEditor::XMLEditor> previousEditor = std::move(xmlEditorInstance);
+    std::unique_ptr<xmlEditor::XMLProject> previousProject = std::move(project);
+    if (pendingProject)
+    {
+        project = std::move(pendingProject);
+        xmlEditorInstance = std::make_unique<xmlEditor::XMLEditor>();
+    }
+    else
+    {
+        xmlEditorInstance = std::move(pendingEditor);
+    }
+
+    // Se carga en el árbol
+    RebuildTree();
+
+    // Muestra las medidas de la carga en la barra de estado
+    const xmlEditor::LoadStats& stats = project ? project->GetLoadStats() : xmlEditorInstance->GetLoadStats();
+    const QString files = project ? tr(" (%1 files)").arg(project->GetDocumentCount()) : QString();
+    ui.statusBar->showMessage(tr("%1 load%2: %3 MB in %4 ms (%5 MB/s), peak RSS %6 MB")
+        .arg(stats.memoryMapped ? tr("Mapped") : tr("Buffered"))
+        .arg(files)
+        .arg(stats.bytes / (1024.0 * 1024.0), 0, 'f', 2)
+        .arg(stats.seconds * 1000.0, 0, 'f', 1)
+        .arg(stats.megabytesPerSecond, 0, 'f', 1)
+        .arg(stats.peakResidentBytes / (1024.0 * 1024.0), 0, 'f', 1));
+
+    // El documento ya se ve; sus capítulos y el índice de palabras se leen ahora en otro hilo
+    StartTextIndex();
+}
+
+void XMLsEditorInteractiveNovels::StartTextIndex()
+{
+    // El índice de cada documento empieza aquí, con su nodo raíz; el hilo sigue con sus capítulos
+    std::vector<std::pair<xmlEditor::XMLEditor*, std::vector<tinyxml2::XMLElement*>>> documents;
+    for (xmlEditor::XMLEditor* document : OpenDocuments())
+    {
+        documents.emplace_back(document, document->BeginTextIndex());
+    }
+    indexCancelled = false;
+    indexFailed = false;
+    indexError.clear();
+    requestedChapter = nullptr;
+    waitingChapters.clear();
+    // Un capítulo que se puso en su sitio tras cancelar dejó su aviso sin recoger
+    chapterAttached.tryAcquire(chapterAttached.available());
+
+    LockEditing(true);
+    loadProgressBar->setFormat(tr("Indexing %p%"));
+    loadProgressBar->setValue(0);
+    loadProgressBar->show();
+    cancelLoadButton->show();
+
+    indexThread = QThread::create([this, documents]() {
+        // Lee un capítulo aquí y espera a que el hilo de la ventana lo ponga en su sitio
+        auto readChapter = [this](xmlEditor::XMLEditor* editor, tinyxml2::XMLElement* chapter) {
+            tinyxml2::XMLNode* content = editor->ReadChapter(chapter);
+            QMetaObject::invokeMethod(this, [this, editor, chapter, content]() {
+                AttachChapter(editor, chapter, content);
+            }, Qt::QueuedConnection);
+            while (!chapterAttached.tryAcquire(1, 50))
+            {
+                if (indexCancelled)
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        std::size_t total = 0;
+        for (const auto& document : documents)
+        {
+            total += document.second.size();
+        }
+        std::size_t indexed = 0;
+        int lastPercent = -1;
+        try {
+            for (const auto& document : documents)
+            {
+                for (tinyxml2::XMLElement* chapter : document.second)
+                {
+                    if (indexCancelled)
+                    {
+                        return;
+                    }
+
+                    // Un capítulo desplegado mientras tanto se lee antes que los demás
+                    if (tinyxml2::XMLElement* requested = requestedChapter.exchange(nullptr))
+                    {
+                        for (const auto& owner : documents)
+                        {
+                            if (owner.first->Contains(requested) && owner.first->IsDeferred(requested) && !readChapter(owner.first, requested))
+                            {
+                                return;
+                            }
+                        }
+                    }
+
+                    // El texto se añade al índice en el orden del documento
+                    if (document.first->IsDeferred(chapter) && !readChapter(document.first, chapter))
+                    {
+                        return;
+                    }
+                    document.first->IndexChapterText(chapter);
+
+                    indexed++;
+                    const int percent = static_cast<int>(indexed * 100 / total);
+                    if (percent != lastPercent)
+                    {
+                        lastPercent = percent;
+                        QMetaObject::invokeMethod(loadProgressBar, "setValue", Qt::QueuedConnection, Q_ARG(int, percent));
+                    }
+                }
+            }
+        }
+        catch (std::runtime_error& e) {
+            indexFailed = true;
+            indexError = e.what();
+        }
+    });
+    connect(indexThread, &QThread::finished, this, &XMLsEditorInteractiveNovels::FinishTextIndex);
+    indexThread->start();
+}
+
+void XMLsEditorInteractiveNovels::AttachChapter(xmlEditor::XMLEditor* editor, tinyxml2::XMLElement* chapter, tinyxml2::XMLNode* content)
+{
+    editor->AttachChapter(chapter, content);
+
+    // Si su fila se desplegó mientras se leía, se muestran ya sus filas
+    QModelIndex index;
+    for (const QPersistentModelIndex& waiting : waitingChapters)
+    {
+        if (waiting.isValid() && model->ElementAt(waiting) == chapter)
+        {
+            index = waiting;
+        }
+    }
+    waitingChapters.erase(std::remove_if(waitingChapters.begin(), waitingChapters.end(), [this, chapter](const QPersistentModelIndex& waiting) {
+        return !waiting.isValid() || model->ElementAt(waiting) == chapter;
+    }), waitingChapters.end());
+    if (index.isValid() && ui.treeView->isExpanded(index))
+    {
+        model->ExpandDeferred(index);
+        model->PopulateInBackground(index);
+    }
+    chapterAttached.release();
+}
+
+void XMLsEditorInteractiveNovels::FinishTextIndex()
+{
+    indexThread->deleteLater();
+    indexThread = nullptr;
+    waitingChapters.clear();
+    loadProgressBar->hide();
+    cancelLoadButton->hide();
+
+    if (indexCancelled)
+    {
+        // Los capítulos que faltan se leen al desplegarlos y el índice en la primera búsqueda
+        LockEditing(false);
+        ui.statusBar->showMessage(tr("Text indexing cancelled; the first search will build the index."), 5000);
+    }
+    else if (indexFailed)
+    {
+        // El capítulo que no se pudo leer sigue sin leer: el documento queda de solo lectura para
+        // no guardarlo ni editarlo a medias, y solo se puede abrir otro
+        LockEditing(true);
+        ui.NewFileMenu->setEnabled(true);
+        ui.LoadFileMenu->setEnabled(true);
+        ui.LoadProjectMenu->setEnabled(true);
+        ui.statusBar->showMessage(tr("Read-only: a chapter could not be read."));
+        QMessageBox::critical(this, "Error", "Failed to read the chapter content. Please check the file and try again.\n" + QString::fromStdString(indexError));
+    }
+    else
+    {
+        LockEditing(false);
+        for (xmlEditor::XMLEditor* document : OpenDocuments())
+        {
+            document->FinishTextIndex();
+        }
+    }
+
+    // Personajes de los capítulos leídos
+    RefreshCharacters();
+}
+
+void XMLsEditorInteractiveNovels::LockEditing(bool locked)
+{
+    liveSearchTimer->stop();
+    searchBox->setEnabled(!locked);
+    replaceAction->setEnabled(!locked);
+    ui.AddNodeButton->setEnabled(!locked);
+    ui.RemoveNodeButton->setEnabled(!locked);
+    ui.NewFileMenu->setEnabled(!locked);
+    ui.LoadFileMenu->setEnabled(!locked);
+    ui.LoadProjectMenu->setEnabled(!locked);
+    ui.SaveFileMenu->setEnabled(!locked);
+    ui.treeView->setEditTriggers(locked ? QAbstractItemView::NoEditTriggers : treeEditTriggers);
+    if (locked)
+    {
+        undoReplaceAction->setEnabled(false);
+    }
+    else
+    {
+        UpdateUndoReplace();
+    }
+}
+
+void XMLsEditorInteractiveNovels::Save()
+{
+    if (project)
+    {
+        // Cada archivo del proyecto se guarda en la carpeta elegida con su ruta relativa
+        QString qDirectoryPath = QFileDialog::getExistingDirectory(this, tr("Save Project To Folder"));
+        if (qDirectoryPath.isEmpty()) {
+            return;
+        }
+
+        try {
+            project->SaveAll(qDirectoryPath.toStdString());
+        }
+        catch (std::runtime_error& e) {
+            QMessageBox::critical(this, "Error", "Failed to save the project.\n" + QString::fromStdString(e.what()));
+            return;
+        }
+
+        QMessageBox::information(this, "Save File", "Project saved successfully.");
+        return;
+    }
+
+    // Solicitar al usuario la ruta del nuevo archivo
+    QString qFilePath = QFileDialog::getSaveFileName(this, tr("Save XML File As"), "", tr("XML Files (*.xml)"));
+    if (qFilePath.isEmpty()) {
+        return;
+    }
+
+    std::string filePath = qFilePath.toStdString();
+
+    // Guardar el archivo XML actualizado; falla si un capítulo sin leer está mal formado
+    try {
+        xmlEditorInstance->SaveFile(filePath);
+    }
+    catch (std::runtime_error& e) {
+        QMessageBox::critical(this, "Error", "Failed to save the file.\n" + QString::fromStdString(e.what()));
+        return;
+    }
+
+    QMessageBox::information(this, "Save File", "File saved successfully.");
+}
+
+void XMLsEditorInteractiveNovels::AddNode()
+{
+    // Primero, obten el elemento seleccionado en el árbol
+    QModelIndex currentIndex = ui.treeView->currentIndex().siblingAtColumn(0);
+
+    if (!currentIndex.isValid())
+    {
+        // No se seleccionó ningún elemento
+        QMessageBox::information(this, tr("Error"), tr("No node selected."));
+        return;
+    }
+
+    // Cada fila del árbol apunta a su nodo XML, aunque haya otros con el mismo nombre
+    tinyxml2::XMLElement* currentXMLNode = model->ElementAt(currentIndex);
+
+    if (currentXMLNode == nullptr)
+    {
+        // No se encontró el nodo correspondiente en el XML
+        QMessageBox::information(this, tr("Error"), tr("No corresponding XML node found."));
+        return;
+    }
+
+    bool ok;
+    QString nodeName = QInputDialog::getText(this, tr("Add Node"), tr("Node name:"), QLineEdit::Normal, "nodeName", &ok);
+    if (ok && !nodeName.isEmpty())
+    {
+        QString nodeAttribute = QInputDialog::getText(this, tr("Add Node Attribute"), tr("Node attribute:"), QLineEdit::Normal, "attribute=value", &ok);
+        if (ok)
+        {
+            // El modelo añade el nodo al documento y solo inserta su fila en el árbol
+            QModelIndex newIndex;
+            try {
+                newIndex = model->AddElement(currentXMLNode, nodeName.toStdString());
+            }
+            catch (std::runtime_error& e) {
+                QMessageBox::critical(this, "Error", "Failed to read the chapter content. Please check the file and try again.");
+                return;
+            }
+            tinyxml2::XMLElement* newNode = model->ElementAt(newIndex);
+            QStringList attrList = nodeAttribute.split('=');
+            if (attrList.size() == 2)
+            {
+                EditorFor(newNode)->ModifyNodeAttribute(newNode, attrList[0].toStdString(), attrList[1].toStdString());
+                RefreshCharacters();
+                UpdateUndoReplace();
+            }
+
+            // Seleccionamos el nuevo elemento en el árbol
+            ui.treeView->setCurrentIndex(newIndex);
+        }
+    }
+}
+
+void XMLsEditorInteractiveNovels::QuitNode()
+{
+    // Primero, obten el elemento seleccionado en el árbol
+    QModelIndex currentIndex = ui.treeView->currentIndex().siblingAtColumn(0);
+
+    if (!currentIndex.isValid())
+    {
+        // No se seleccionó ningún elemento
+        QMessageBox::information(this, tr("Error"), tr("No node selected."));
+        return;
+    }
+
+    // Cada fila del árbol apunta a su nodo XML, aunque haya otros con el mismo nombre
+    tinyxml2::XMLElement* currentXMLNode = model->ElementAt(currentIndex);
+
+    if (currentXMLNode == nullptr)
+    {
+        // No se encontró el nodo correspondiente en el XML
+        QMessageBox::information(this, tr("Error"), tr("No corresponding XML node found."));
+        return;
+    }
+
+    // Comprobando si currentXMLNode y su padre no son nullptr antes de proceder
+    if (currentXMLNode->Parent() && currentXMLNode->Parent()->ToElement())
+    {
+        // Los resultados de la búsqueda podrían apuntar al nodo borrado
+        searchResults.clear();
+        lastSearch.clear();
+
+        // El modelo quita el nodo del documento y solo su fila del árbol
+        QModelIndex newCurrentIndex = model->RemoveElement(currentXMLNode);
+
+        // Seleccionamos el elemento correspondiente al padre en el árbol
+        ui.treeView->setCurrentIndex(newCurrentIndex);
+        RefreshCharacters();
+        UpdateUndoReplace();
+    }
+    else
+    {
+        QMessageBox::information(this, tr("Error"), tr("Cannot remove root node."));
+    }
+}
+
+void XMLsEditorInteractiveNovels::RebuildTree()
+{
+    // Los resultados de la búsqueda y los reemplazos eran del documento anterior
+    searchResults.clear();
+    lastSearch.clear();
+    replaceHistory.clear();
+    undoReplaceAction->setEnabled(false);
+
+    // Los documentos nuevos se muestran sin filtro (SetDocuments lo quita)
+    {
+        const QSignalBlocker blocker(characterList);
+        characterList->setCurrentRow(-1);
+    }
+    if (!project)
+    {
+        model->SetDocuments({ xmlEditorInstance.get() });
+        RefreshCharacters();
+        return;
+    }
+
+    // Raíz común del proyecto; cada archivo cuelga de ella con su nodo raíz
+    std::vector<xmlEditor::XMLEditor*> documents;
+    QStringList documentPaths;
+    for (std::size_t i = 0; i < project->GetDocumentCount(); i++)
+    {
+        documents.push_back(&project->GetDocument(i));
+        documentPaths << QString::fromStdString(project->GetRelativePath(i));
+    }
+    model->SetDocuments(documents, QString::fromStdString(project->GetName()), documentPaths);
+    RefreshCharacters();
+}
+
+std::vector<xmlEditor::XMLEditor*> XMLsEditorInteractiveNovels::OpenDocuments()
+{
+    std::vector<xmlEditor::XMLEditor*> documents;
+    if (project)
+    {
+        for (std::size_t i = 0; i < project->GetDocumentCount(); i++)
+        {
+            documents.push_back(&project->GetDocument(i));
+        }
+    }
+    else
+    {
+        documents.push_back(xmlEditorInstance.get());
+    }
+    return documents;
+}
+
+xmlEditor::XMLEditor* XMLsEditorInteractiveNovels::EditorFor(const tinyxml2::XMLElement* element)
+{
+    xmlEditor::XMLEditor* editor = project ? project->FindDocument(element) : nullptr;
+    return editor ? editor : xmlEditorInstance.get();
+}
+
+void XMLsEditorInteractiveNovels::ExpandItem(const QModelIndex& index)
+{
+    // Mientras se construye el índice los capítulos se leen en su hilo: este pasa delante de los
+    // demás y sus filas se muestran al ponerlo en su sitio
+    tinyxml2::XMLElement* element = model->ElementAt(index);
+    if (indexThread && element != nullptr && EditorFor(element)->IsDeferred(element))
+    {
+        requestedChapter = element;
+        waitingChapters.emplace_back(index);
+        return;
+    }
+
+    // Solo los capítulos sin leer tienen la fila provisional
+    try {
+        model->ExpandDeferred(index);
+    }
+    catch (std::runtime_error& e) {
+        QMessageBox::critical(this, "Error", "Failed to read the chapter content. Please check the file and try again.");
+        return;
+    }
+
+    // Las primeras filas ya se ven; el resto del nodo se añade sin bloquear la ventana
+    model->PopulateInBackground(index);
+}
+
+void XMLsEditorInteractiveNovels::Search()
+{
+    const QString query = searchBox->text().trimmed();
+    if (query.isEmpty())
+    {
+        return;
+    }
+
+    // La búsqueda mientras se escribe ya no hace falta
+    liveSearchTimer->stop();
+
+    if (query != lastSearch || searchResults.empty() || liveResults)
+    {
+        // Se buscan en todos los documentos con su índice de palabras, en el orden del árbol
+        QElapsedTimer timer;
+        timer.start();
+        searchResults.clear();
+        searchPosition = 0;
+        liveResults = false;
+        bool similar = false;
+        try {
+            for (xmlEditor::XMLEditor* document : OpenDocuments())
+            {
+                const std::vector<tinyxml2::XMLElement*> found = document->FindText(query.toStdString());
+                searchResults.insert(searchResults.end(), found.begin(), found.end());
+            }
+            if (searchResults.empty())
+            {
+                // Sin coincidencias exactas se muestran las parecidas, sin límite de tiempo
+                searchResults = FindSimilar(query.toStdString());
+                similar = true;
+            }
+        }
+        catch (std::runtime_error& e) {
+            QMessageBox::critical(this, "Error", "Failed to read the chapter content. Please check the file and try again.");
+            return;
+        }
+        lastSearch = query;
+        if (searchResults.empty())
+        {
+            ui.statusBar->showMessage(tr("No matches for \"%1\".").arg(query), 5000);
+            return;
+        }
+        const QString message = similar ? tr("No exact matches; %1 similar matches in %2 ms.") : tr("%1 matches in %2 ms.");
+        ui.statusBar->showMessage(message.arg(searchResults.size()).arg(timer.elapsed()), 5000);
+    }
+    else
+    {
+        searchPosition = (searchPosition + 1) % searchResults.size();
+        ui.statusBar->showMessage(tr("Match %1 of %2.").arg(searchPosition + 1).arg(searchResults.size()), 5000);
+    }
+    ShowSearchResult();
+}
+
+void XMLsEditorInteractiveNovels::LiveSearch()
+{
+    const QString query = searchBox->text().trimmed();
+    if (query.size() < LiveSearchMinLength || query == lastSearch)
+    {
+        return;
+    }
+
+    // Las más parecidas que dé tiempo a encontrar; Enter hace después la búsqueda exacta
+    QElapsedTimer timer;
+    timer.start();
+    std::vector<tinyxml2::XMLElement*> found;
+    try {
+        found = FindSimilar(query.toStdString(), std::chrono::steady_clock::now() + LiveSearchBudget);
+    }
+    catch (std::runtime_error& e) {
+        ui.statusBar->showMessage(tr("Failed to read the chapter content."), 5000);
+        return;
+    }
+    searchResults = std::move(found);
+    searchPosition = 0;
+    lastSearch = query;
+    liveResults = true;
+    if (searchResults.empty())
+    {
+        ui.statusBar->showMessage(tr("No similar matches for \"%1\".").arg(query), 5000);
+        return;
+    }
+    ui.statusBar->showMessage(tr("%1 similar matches in %2 ms; press Enter for exact matches.").arg(searchResults.size()).arg(timer.elapsed()), 5000);
+    ShowSearchResult();
+}
+
+std::vector<tinyxml2::XMLElement*> XMLsEditorInteractiveNovels::FindSimilar(const std::string& query, std::chrono::steady_clock::time_point deadline)
+{
+    // Cada documento da las suyas ordenadas; se juntan por distancia sin perder ese orden
+    std::vector<xmlEditor::FuzzyMatch> matches;
+    for (xmlEditor::XMLEditor* document : OpenDocuments())
+    {
+        if (document->GetRootNode() == nullptr)
+        {
+            continue;
+        }
+        const std::vector<xmlEditor::FuzzyMatch> found = document->FindFuzzy(query, SimilarResultLimit, deadline);
+        matches.insert(matches.end(), found.begin(), found.end());
+    }
+    std::stable_sort(matches.begin(), matches.end(), [](const xmlEditor::FuzzyMatch& a, const xmlEditor::FuzzyMatch& b) {
+        return a.distance < b.distance;
+    });
+    std::vector<tinyxml2::XMLElement*> elements;
+    for (std::size_t i = 0; i < matches.size() && i < SimilarResultLimit; i++)
+    {
+        elements.push_back(matches[i].element);
+    }
+    return elements;
+}
+
+void XMLsEditorInteractiveNovels::ShowSearchResult()
+{
+    // El árbol despliega los nodos padre al mostrar la fila
+    QModelIndex index;
+    try {
+        index = model->RevealElement(searchResults[searchPosition]);
+    }
+    catch (std::runtime_error& e) {
+        QMessageBox::critical(this, "Error", "Failed to read the chapter content. Please check the file and try again.");
+        return;
+    }
+    if (index.isValid())
+    {
+        ui.treeView->setCurrentIndex(index);
+        ui.treeView->scrollTo(index);
+    }
+}
+
+void XMLsEditorInteractiveNovels::RefreshCharacters()
+{
+    // Un mismo personaje puede hablar en varios archivos del proyecto
+    std::map<std::string, xmlEditor::CharacterStats> characters;
+    try {
+        for (xmlEditor::XMLEditor* document : OpenDocuments())
+        {
+            if (document->GetRootNode() == nullptr)
+            {
+                continue;
+            }
+            for (const xmlEditor::CharacterStats& character : document->GetCharacters())
+            {
+                xmlEditor::CharacterStats& total = characters[character.name];
+                total.name = character.name;
+                total.lines += character.lines;
+                total.words += character.words;
+            }
+        }
+    }
+    catch (std::runtime_error& e) {
+        QMessageBox::critical(this, "Error", "Failed to read the chapter content. Please check the file and try again.");
+        return;
+    }
+
+    // Se conserva el personaje elegido sin volver a filtrar el árbol
+    const QListWidgetItem* current = characterList->currentItem();
+    const QString currentName = current ? current->data(Qt::UserRole).toString() : QString();
+    const QSignalBlocker blocker(characterList);
+    characterList->clear();
+    QListWidgetItem* allItem = new QListWidgetItem(tr("All characters"), characterList);
+    allItem->setData(Qt::UserRole, QString());
+    for (const auto& entry : characters)
+    {
+        const QString name = QString::fromStdString(entry.first);
+        QListWidgetItem* item = new QListWidgetItem(tr("%1 (%2 lines, %3 words)").arg(name).arg(entry.second.lines).arg(entry.second.words), characterList);
+        item->setData(Qt::UserRole, name);
+        if (name == currentName)
+        {
+            characterList->setCurrentItem(item);
+        }
+    }
+    if (characterList->currentItem() == nullptr)
+    {
+        characterList->setCurrentItem(allItem);
+    }
+}
+
+void XMLsEditorInteractiveNovels::FilterCharacter()
+{
+    const QListWidgetItem* item = characterList->currentItem();
+    const QString name = item ? item->data(Qt::UserRole).toString() : QString();
+    if (name.isEmpty())
+    {
+        model->ClearFilter();
+        return;
+    }
+
+    // Las intervenciones vienen del índice de cada documento, sin recorrer el árbol
+    std::vector<tinyxml2::XMLElement*> lines;
+    try {
+        for (xmlEditor::XMLEditor* document : OpenDocuments())
+        {
+            if (document->GetRootNode() == nullptr)
+            {
+                continue;
+            }
+            const std::vector<tinyxml2::XMLElement*>& found = document->GetCharacterLines(name.toStdString());
+            lines.insert(lines.end(), found.begin(), found.end());
+        }
+    }
+    catch (std::runtime_error& e) {
+        QMessageBox::critical(this, "Error", "Failed to read the chapter content. Please check the file and try again.");
+        return;
+    }
+    model->SetFilter(lines);
+    ui.statusBar->showMessage(tr("%1: %2 lines.").arg(name).arg(lines.size()), 5000);
+    if (lines.empty())
+    {
+        return;
+    }
+
+    // Con pocas intervenciones se despliega todo; si no, solo el camino hasta la primera
+    if (lines.size() <= CharacterExpandLimit)
+    {
+        ui.treeView->expandAll();
+    }
+    const QModelIndex first = model->RevealElement(lines.front());
+    if (first.isValid())
+    {
+        ui.treeView->setCurrentIndex(first);
+        ui.treeView->scrollTo(first);
+    }
+}
+
+void XMLsEditorInteractiveNovels::ReplaceAll()
+{
+    // Ventana con el texto buscado, el reemplazo y las opciones
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Replace"));
+    QFormLayout* layout = new QFormLayout(&dialog);
+    QLineEdit* findBox = new QLineEdit(searchBox->text().trimmed(), &dialog);
+    QLineEdit* replaceBox = new QLineEdit(&dialog);
+    QCheckBox* regexBox = new QCheckBox(tr("Regular expression ($1 in the replacement)"), &dialog);
+    QCheckBox* matchCaseBox = new QCheckBox(tr("Match case"), &dialog);
+    matchCaseBox->setChecked(true);
+    QCheckBox* attributesBox = new QCheckBox(tr("Also in attribute values"), &dialog);
+    attributesBox->setChecked(true);
+    QDialogButtonBox* buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    layout->addRow(tr("Find:"), findBox);
+    layout->addRow(tr("Replace with:"), replaceBox);
+    layout->addRow(regexBox);
+    layout->addRow(matchCaseBox);
+    layout->addRow(attributesBox);
+    layout->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    if (dialog.exec() != QDialog::Accepted || findBox->text().isEmpty())
+    {
+        return;
+    }
+
+    xmlEditor::ReplaceOptions options;
+    options.regex = regexBox->isChecked();
+    options.matchCase = matchCaseBox->isChecked();
+    options.attributes = attributesBox->isChecked();
+
+    // Primero se buscan los cambios en todos los documentos, sin tocarlos, para confirmarlos
+    QElapsedTimer timer;
+    timer.start();
+    std::vector<std::pair<xmlEditor::XMLEditor*, std::vector<xmlEditor::Replacement>>> pending;
+    std::size_t total = 0;
+    try {
+        for (xmlEditor::XMLEditor* document : OpenDocuments())
+        {
+            if (document->GetRootNode() == nullptr)
+            {
+                continue;
+            }
+            std::vector<xmlEditor::Replacement> changes = document->FindReplacements(findBox->text().toStdString(), replaceBox->text().toStdString(), options);
+            if (!changes.empty())
+            {
+                total += changes.size();
+                pending.emplace_back(document, std::move(changes));
+            }
+        }
+    }
+    catch (std::invalid_argument& e) {
+        QMessageBox::warning(this, tr("Replace"), QString::fromStdString(e.what()));
+        return;
+    }
+    catch (std::runtime_error& e) {
+        QMessageBox::critical(this, "Error", "Failed to read the chapter content. Please check the file and try again.");
+        return;
+    }
+    if (total == 0)
+    {
+        ui.statusBar->showMessage(tr("No matches for \"%1\".").arg(findBox->text()), 5000);
+        return;
+    }
+    const qint64 findTime = timer.elapsed();
+    if (QMessageBox::question(this, tr("Replace"), tr("Replace %1 values?").arg(total)) != QMessageBox::Yes)
+    {
+        return;
+    }
+
+    // Cada documento aplica sus cambios de una vez y el árbol solo vuelve a pintar esas filas
+    timer.restart();
+    std::vector<xmlEditor::XMLEditor*> changed;
+    std::vector<tinyxml2::XMLElement*> nodes;
+    std::size_t applied = 0;
+    for (const auto& entry : pending)
+    {
+        const std::vector<xmlEditor::Replacement> done = entry.first->ApplyReplacements(entry.second);
+        if (done.empty())
+        {
+            continue;
+        }
+        changed.push_back(entry.first);
+        applied += done.size();
+        for (const xmlEditor::Replacement& change : done)
+        {
+            nodes.push_back(change.node);
+        }
+    }
+    if (!changed.empty())
+    {
+        replaceHistory.push_back(changed);
+    }
+    searchResults.clear();
+    lastSearch.clear();
+    model->RefreshElements(nodes);
+    UpdateUndoReplace();
+    ui.statusBar->showMessage(tr("%1 values replaced (search %2 ms, replace %3 ms).").arg(applied).arg(findTime).arg(timer.elapsed()), 5000);
+}
+
+void XMLsEditorInteractiveNovels::UndoReplace()
+{
+    UpdateUndoReplace();
+    if (replaceHistory.empty())
+    {
+        return;
+    }
+    const std::vector<xmlEditor::XMLEditor*> documents = replaceHistory.back();
+    replaceHistory.pop_back();
+
+    std::vector<tinyxml2::XMLElement*> nodes;
+    for (xmlEditor::XMLEditor* document : documents)
+    {
+        for (const xmlEditor::Replacement& change : document->Undo())
+        {
+            nodes.push_back(change.node);
+        }
+    }
+    searchResults.clear();
+    lastSearch.clear();
+    model->RefreshElements(nodes);
+    UpdateUndoReplace();
+    ui.statusBar->showMessage(tr("%1 values restored.").arg(nodes.size()), 5000);
+}
+
+void XMLsEditorInteractiveNovels::UpdateUndoReplace()
+{
+    // Un cambio a mano vacía el historial de su documento; los reemplazos que lo incluían ya no se
+    // pueden deshacer enteros y se olvidan todos
+    for (const std::vector<xmlEditor::XMLEditor*>& documents : replaceHistory)
+    {
+        const bool broken = std::any_of(documents.begin(), documents.end(), [](const xmlEditor::XMLEditor* document) {
+            return !document->CanUndo();
+        });
+        if (broken)
+        {
+            replaceHistory.clear();
+            break;
+        }
+    }
+    undoReplaceAction->setEnabled(!replaceHistory.empty());
+}